@@ -0,0 +1,2994 @@
+// the simulation core behind gol.h: rules, the stepping engines, history, patterns and board files
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define MAX_RADIUS 16
+#define MAX_NEIGHBORS ((2 * MAX_RADIUS + 1) * (2 * MAX_RADIUS + 1))
+#define LENIA_DEFAULT ((GolLenia){ 0.15, 0.015, 0.1, 13 })
+
+#include <stdbool.h>
+#include <complex.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include "gol.h"
+
+// a bit-packed board file (PBM P4) read one row at a time,
+// memory-mapped where available so rows stream straight from the page cache
+typedef struct {
+    int w;
+    int h;
+    size_t row_bytes;
+    long data_offset;
+    FILE *file;
+    const unsigned char *map;
+    size_t map_size;
+    // the row read last, when the file couldn't be mapped
+    unsigned char *row;
+} BoardFile;
+
+// one retained generation. `delta` holds the cells that flipped since the previous
+// entry as varint-encoded gaps between cell indices, so stepping between neighbouring
+// entries costs O(changes). every `keyframe_interval` entries (and after edits)
+// the whole board is also kept bit-packed in `keyframe` for long jumps.
+typedef struct {
+    long generation;
+    bool has_delta;
+    unsigned char *delta;
+    size_t delta_size;
+    unsigned char *keyframe;
+} HistoryEntry;
+
+typedef struct {
+    HistoryEntry *entries;
+    int count;
+    int capacity;
+    int cursor;
+    size_t cells;
+    size_t bytes;
+    size_t budget;
+    int keyframe_interval;
+    int since_keyframe;
+    bool edited;
+} History;
+
+// what a cell looks at and what it does with the count.
+// birth / survive are indexed by the number of live neighbours (the cell itself excluded).
+typedef struct {
+    char name[64];
+    int neighborhood;
+    int radius;
+    int states;
+    bool conway;
+    bool birth[MAX_NEIGHBORS + 1];
+    bool survive[MAX_NEIGHBORS + 1];
+} Rule;
+
+// cell states of "Generations" rules (more than two states), stored as 2 or 4 bit planes
+// of 64 cells per word. state 1 is alive, 2 and up are dying and only count down to 0.
+// while they're stepped the planes are the board, its cells are unpacked from them only
+// when something reads them (see cells_sync) and edits are packed back by rectangle.
+typedef struct {
+    int w;
+    int h;
+    int stride;
+    int planes;
+    uint64_t *plane[4];
+    uint64_t *alive;
+    uint64_t *west;
+    uint64_t *east;
+} GenBoard;
+
+// a 1D FFT of one length: the roots of unity and scratch for the butterflies.
+// any length works, it's split by its smallest prime factor at each level.
+typedef struct {
+    int n;
+    float complex *roots;
+    float complex *scratch;
+} Fft;
+
+// continuous cells in [0, 1] grown by a smooth ring kernel of `radius` cells (Lenia).
+// the kernel is convolved in frequency space, its transform is computed once.
+// cells >= 0.5 are mirrored as live cells on the board.
+typedef struct {
+    int w;
+    int h;
+    int radius;
+    float mu;
+    float sigma;
+    float dt;
+    float *cells;
+    float complex *kernel;
+    float complex *field;
+    float complex *line;
+    Fft fft_x;
+    Fft fft_y;
+} Lenia;
+
+// the tile rows first_row, first_row + row_step, ... of one step_tiled() call,
+// each thread gets its own
+typedef struct {
+    const Rule *rule;
+    const bool *src;
+    bool *dst;
+    int w;
+    int h;
+    int k;
+    bool *dirty;
+    int first_row;
+    int row_step;
+} TileJob;
+
+// the runs of one gol_verify() call, a run being every engine on one rule and board size.
+// its threads take the next run under the lock and add up their results there.
+typedef struct {
+    const char **rules;
+    int rule_count;
+    int generations;
+    int threads;
+    pthread_mutex_t lock;
+    int next;
+    int checks;
+    int failures;
+} VerifyJob;
+
+typedef struct {
+    bool n1: 1;
+    bool n2: 1;
+    bool n3: 1;
+    bool n4: 1;
+    bool n5: 1;
+    bool n6: 1;
+    bool n7: 1;
+    bool n8: 1;
+} Neighbors;
+
+struct GolBoard {
+    int w;
+    int h;
+    Rule rule;
+    int engine;
+    int threads;
+    int temporal_steps;
+    bool *cells;
+    bool *next;
+    bool *dirty;
+    bool *pinned;
+    GenBoard gen;
+    Lenia lenia;
+    GolLenia lenia_params;
+    History history;
+    bool history_enabled;
+    unsigned char *age;
+    // the planes have stepped past `cells`
+    bool cells_stale;
+    long generation;
+    double step_ms;
+};
+
+static GolLogFunc log_func = NULL;
+
+static void gol_log(int level, const char *format, ...);
+static bool engine_runs(int engine, const Rule *rule);
+static void board_planes_init(GolBoard *board);
+static bool board_on_planes(const GolBoard *board);
+static void cells_sync(const GolBoard *board);
+static Neighbors get_neighbors(const bool *board, int w, int h, int x, int y);
+static bool new_state(const Rule *rule, bool is_alive, Neighbors nbrs);
+static bool rule_apply(const Rule *rule, bool is_alive, int count);
+static bool rule_parse(const char *text, Rule *out);
+static int step_board(GolBoard *board, int k);
+static void step_neighborhood(const Rule *rule, const bool *src, bool *dst, int w, int h);
+static void gen_board_init(GenBoard *gb, int w, int h, int states);
+static void gen_board_free(GenBoard *gb);
+static int gen_board_get(const GenBoard *gb, int x, int y);
+static void gen_board_sync(GenBoard *gb, const bool *board, int x0, int y0, int x1, int y1);
+static void gen_board_unpack(const GenBoard *gb, bool *board);
+static long gen_board_population(const GenBoard *gb);
+static void step_generations(const Rule *rule, GenBoard *gb);
+static float complex complex_mul(float complex a, float complex b);
+static bool fft_init(Fft *fft, int n);
+static void fft_free(Fft *fft);
+static void fft_run(Fft *fft, const float complex *in, int stride, float complex *out, int n, int step);
+static void fft_2d(Lenia *lenia, float complex *data, bool inverse);
+static bool lenia_init(Lenia *lenia, int w, int h, GolLenia params);
+static void lenia_free(Lenia *lenia);
+static void lenia_kernel(Lenia *lenia);
+static void lenia_sync(Lenia *lenia, const bool *board);
+static void lenia_step(Lenia *lenia, const bool *src, bool *dst);
+static void step_reference(const Rule *rule, const bool *src, bool *dst, int w, int h);
+static void step_reference_states(const Rule *rule, const unsigned char *src, unsigned char *dst, int w, int h);
+static void step_tiled(const Rule *rule, const bool *src, bool *dst, int w, int h, int k, bool *dirty, int threads);
+static void *step_tiled_rows(void *arg);
+static bool pbm_read_header(FILE *file, int *w, int *h);
+static bool board_file_open(BoardFile *bf, const char *path);
+static void board_file_row(BoardFile *bf, int y, bool *out);
+static void board_file_close(BoardFile *bf);
+static bool stream_generation(const Rule *rule, const char *in_path, const char *out_path);
+static bool pbm_write(const char *path, const bool *board, int w, int h);
+static void pack_row(const bool *row, int w, unsigned char *out);
+static uint64_t expand_byte(unsigned bits);
+static void age_update(unsigned char *age, const bool *cells, size_t count);
+static void verify_reference(const Rule *rule, const unsigned char *src, unsigned char *dst, int w, int h);
+static bool verify_runs(int engine, const Rule *rule);
+static int verify_step(const Rule *rule, int engine, GolBoard *board, const unsigned char *src, unsigned char *dst, int w, int h, int threads, const char *paths[2]);
+static GolBoard *verify_board(const Rule *rule, int engine, const unsigned char *start, int w, int h, int threads);
+static int verify_run(const Rule *rule, const char *rule_text, int w, int h, unsigned seed, int generations, int threads, const char *paths[2], int *checks);
+static void *verify_worker(void *arg);
+static bool verify_temp_file(char *path, size_t size);
+static void history_init(History *history, size_t cells, size_t budget, int keyframe_interval);
+static void history_free(History *history);
+static void history_record(History *history, const bool *before, long before_generation, const bool *after, long after_generation);
+static void history_mark_edited(History *history);
+static void history_seek(History *history, bool *board, int target);
+static void history_apply_delta(const HistoryEntry *entry, bool *board);
+static void history_load_keyframe(const History *history, const HistoryEntry *entry, bool *board);
+static double now_seconds(void);
+static void *grid_alloc(size_t size, const char *name);
+static void grid_free(void *buffer, size_t size);
+#if defined(__linux__)
+static void thp_mode(char *mode, size_t size);
+static size_t thp_bytes(const void *buffer);
+#endif
+enum
+{
+    MOORE,
+    VON_NEUMANN,
+    HEX
+};
+
+void gol_set_log(GolLogFunc log)
+{
+    log_func = log;
+}
+
+static void gol_log(int level, const char *format, ...)
+{
+    char text[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    
+    if(log_func != NULL)
+    {
+        log_func(level, text);
+        return;
+    }
+    
+    static const char *names[] = { "INFO", "WARNING", "ERROR" };
+    if(level != GOL_LOG_INFO)
+        fprintf(stderr, "%s: %s\n", names[level], text);
+}
+
+GolBoard *gol_create(int w, int h, const char *rule)
+{
+    if(w < 1 || h < 1)
+        return NULL;
+    
+    GolBoard *board = calloc(1, sizeof(GolBoard));
+    if(board == NULL)
+        return NULL;
+    if(!rule_parse(rule, &board->rule))
+    {
+        gol_log(GOL_LOG_ERROR, "RULE: can't parse \"%s\"", rule);
+        free(board);
+        return NULL;
+    }
+    
+    size_t cells = (size_t)w * h;
+    board->w = w;
+    board->h = h;
+    board->engine = GOL_ENGINE_AUTO;
+    board->threads = 1;
+    board->temporal_steps = GOL_TEMPORAL_STEPS;
+    board->lenia_params = LENIA_DEFAULT;
+    board->cells = grid_alloc(cells, "grid");
+    board->next  = grid_alloc(cells, "grid2");
+    board->dirty = calloc((size_t)((w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE) * ((h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE), sizeof(bool));
+    if(board->cells == NULL || board->next == NULL || board->dirty == NULL)
+    {
+        gol_destroy(board);
+        return NULL;
+    }
+    
+    if(board->rule.states > 2)
+        gen_board_init(&board->gen, w, h, board->rule.states);
+    
+    return board;
+}
+
+void gol_destroy(GolBoard *board)
+{
+    if(board == NULL)
+        return;
+    
+    size_t cells = (size_t)board->w * board->h;
+    grid_free(board->cells, cells);
+    grid_free(board->next, cells);
+    free(board->dirty);
+    gen_board_free(&board->gen);
+    lenia_free(&board->lenia);
+    history_free(&board->history);
+    free(board->age);
+    free(board);
+}
+
+bool gol_rule_valid(const char *rule)
+{
+    Rule parsed;
+    return rule_parse(rule, &parsed);
+}
+
+// the fixed engines only run two state rules on the 8 cell Moore neighbourhood,
+// except for the packed one which also runs multi-state rules
+static bool engine_runs(int engine, const Rule *rule)
+{
+    if(engine == GOL_ENGINE_AUTO || engine == GOL_ENGINE_LENIA)
+        return true;
+    if(rule->neighborhood != MOORE || rule->radius != 1)
+        return false;
+    return rule->states == 2 || engine == GOL_ENGINE_PACKED;
+}
+
+// the packed engine and multi-state rules keep their cells on bit planes,
+// which start over from the live cells whenever the rule changes
+static void board_planes_init(GolBoard *board)
+{
+    cells_sync(board);
+    gen_board_free(&board->gen);
+    if(board->rule.states > 2 || board->engine == GOL_ENGINE_PACKED)
+    {
+        gen_board_init(&board->gen, board->w, board->h, board->rule.states);
+        gen_board_sync(&board->gen, board->cells, 0, 0, board->w - 1, board->h - 1);
+    }
+}
+
+// whether the planes are what's being stepped, Lenia steps the cells even when there are planes
+static bool board_on_planes(const GolBoard *board)
+{
+    return board->gen.plane[0] != NULL && board->engine != GOL_ENGINE_LENIA;
+}
+
+// unpacks the planes into the cells if they've been stepped without
+// anything reading the cells. the cells are a cache of the planes then,
+// so boards passed as const are brought up to date too.
+static void cells_sync(const GolBoard *board)
+{
+    if(!board->cells_stale)
+        return;
+    GolBoard *mutable = (GolBoard*)board;
+    gen_board_unpack(&mutable->gen, mutable->cells);
+    mutable->cells_stale = false;
+}
+
+bool gol_set_rule(GolBoard *board, const char *rule)
+{
+    Rule parsed;
+    if(!rule_parse(rule, &parsed))
+    {
+        gol_log(GOL_LOG_ERROR, "RULE: can't parse \"%s\"", rule);
+        return false;
+    }
+    if(!engine_runs(board->engine, &parsed))
+    {
+        gol_log(GOL_LOG_ERROR, "RULE: \"%s\" needs the auto engine", rule);
+        return false;
+    }
+    
+    board->rule = parsed;
+    board_planes_init(board);
+    memset(board->dirty, true, (size_t)((board->w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE) * ((board->h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE));
+    return true;
+}
+
+const char *gol_rule(const GolBoard *board)
+{
+    return board->rule.name;
+}
+
+int gol_rule_states(const GolBoard *board)
+{
+    return board->rule.states;
+}
+
+bool gol_set_engine(GolBoard *board, int engine)
+{
+    if(engine < GOL_ENGINE_AUTO || engine > GOL_ENGINE_LENIA)
+        return false;
+    if(!engine_runs(engine, &board->rule))
+    {
+        gol_log(GOL_LOG_ERROR, "RULE: \"%s\" needs the auto engine", board->rule.name);
+        return false;
+    }
+    
+    if(engine == GOL_ENGINE_LENIA && board->lenia.cells == NULL && !lenia_init(&board->lenia, board->w, board->h, board->lenia_params))
+        return false;
+    
+    cells_sync(board);
+    bool planes = board->rule.states > 2 || board->engine == GOL_ENGINE_PACKED;
+    board->engine = engine;
+    if(planes != (board->rule.states > 2 || engine == GOL_ENGINE_PACKED))
+        board_planes_init(board);
+    else if(board_on_planes(board))
+        gen_board_sync(&board->gen, board->cells, 0, 0, board->w - 1, board->h - 1);
+    return true;
+}
+
+void gol_set_threads(GolBoard *board, int threads)
+{
+    board->threads = threads < 1 ? 1 : threads > GOL_MAX_THREADS ? GOL_MAX_THREADS : threads;
+}
+
+void gol_set_temporal_steps(GolBoard *board, int steps)
+{
+    board->temporal_steps = steps < 1 ? 1 : steps;
+}
+
+int gol_width(const GolBoard *board)
+{
+    return board->w;
+}
+
+int gol_height(const GolBoard *board)
+{
+    return board->h;
+}
+
+bool gol_get(const GolBoard *board, int x, int y)
+{
+    x = gol_wrap(x, board->w);
+    y = gol_wrap(y, board->h);
+    if(board->cells_stale)
+        return gen_board_get(&board->gen, x, y) == 1;
+    return board->cells[y * board->w + x];
+}
+
+void gol_set(GolBoard *board, int x, int y, bool alive)
+{
+    x = gol_wrap(x, board->w);
+    y = gol_wrap(y, board->h);
+    board->cells[y * board->w + x] = alive;
+    gol_cells_changed(board, x, y, x, y);
+}
+
+bool *gol_cells(GolBoard *board)
+{
+    cells_sync(board);
+    return board->cells;
+}
+
+// flags the tiles the rectangle touches (clipped to the board), packs it into the planes
+// while they're stepped, restarts the ages in it and tells the history the board no longer
+// matches its last entry
+void gol_cells_changed(GolBoard *board, int x0, int y0, int x1, int y1)
+{
+    int tiles_x = (board->w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE;
+    x0 = x0 < 0 ? 0 : x0 >= board->w ? board->w - 1 : x0;
+    x1 = x1 < 0 ? 0 : x1 >= board->w ? board->w - 1 : x1;
+    y0 = y0 < 0 ? 0 : y0 >= board->h ? board->h - 1 : y0;
+    y1 = y1 < 0 ? 0 : y1 >= board->h ? board->h - 1 : y1;
+    
+    for(int ty = y0 / GOL_TILE_SIZE ; ty <= y1 / GOL_TILE_SIZE ; ty++)
+        for(int tx = x0 / GOL_TILE_SIZE ; tx <= x1 / GOL_TILE_SIZE ; tx++)
+            board->dirty[ty * tiles_x + tx] = true;
+    
+    if(board_on_planes(board))
+        gen_board_sync(&board->gen, board->cells, x0, y0, x1, y1);
+    if(board->age != NULL)
+        for(int y = y0 ; y <= y1 ; y++)
+            for(int x = x0 ; x <= x1 ; x++)
+                board->age[y * board->w + x] = board->cells[y * board->w + x];
+    
+    history_mark_edited(&board->history);
+}
+
+bool *gol_dirty_tiles(GolBoard *board)
+{
+    return board->dirty;
+}
+
+void gol_pin_cells(GolBoard *board, bool pinned)
+{
+    cells_sync(board);
+    board->pinned = pinned ? board->cells : NULL;
+}
+
+void gol_pack(const GolBoard *board, unsigned char *out)
+{
+    cells_sync(board);
+    size_t row_bytes = (board->w + 7) / 8;
+    for(int y = 0 ; y < board->h ; y++)
+        pack_row(board->cells + (size_t)y * board->w, board->w, out + y * row_bytes);
+}
+
+// `temporal_steps` generations at a time where the engine can, every chunk
+// recorded in the history. ages need every generation, so they step one at a time.
+long gol_step(GolBoard *board, long generations)
+{
+    double begin = now_seconds();
+    long done = 0;
+    
+    // cells written through a pinned buffer never reach gol_cells_changed(),
+    // they're packed into the planes before stepping instead
+    if(board->pinned != NULL && board_on_planes(board))
+        gen_board_sync(&board->gen, board->cells, 0, 0, board->w - 1, board->h - 1);
+    
+    while(done < generations)
+    {
+        int k = generations - done < board->temporal_steps ? generations - done : board->temporal_steps;
+        if(board->age != NULL)
+            k = 1;
+        k = step_board(board, k);
+        if(board->age != NULL)
+            age_update(board->age, board->next, (size_t)board->w * board->h);
+        if(board->history_enabled)
+            history_record(&board->history, board->cells, board->generation, board->next, board->generation + k);
+        board->generation += k;
+        done += k;
+        
+        bool *temp = board->cells;
+        board->cells = board->next;
+        board->next = temp;
+    }
+    
+    if(board->pinned != NULL)
+        cells_sync(board);
+    if(board->pinned != NULL && board->cells != board->pinned)
+    {
+        memcpy(board->pinned, board->cells, (size_t)board->w * board->h);
+        board->next = board->cells;
+        board->cells = board->pinned;
+    }
+    
+    if(done > 0)
+        board->step_ms = (now_seconds() - begin) * 1000 / done;
+    return done;
+}
+
+bool gol_set_age(GolBoard *board, bool enabled)
+{
+    if(!enabled)
+    {
+        free(board->age);
+        board->age = NULL;
+        return true;
+    }
+    if(board->age != NULL)
+        return true;
+    
+    cells_sync(board);
+    size_t cells = (size_t)board->w * board->h;
+    board->age = malloc(cells);
+    if(board->age == NULL)
+    {
+        gol_log(GOL_LOG_WARNING, "AGE: can't allocate %zu bytes, ages stay off", cells);
+        return false;
+    }
+    for(size_t i = 0 ; i < cells ; i++)
+        board->age[i] = board->cells[i];
+    return true;
+}
+
+const unsigned char *gol_age(const GolBoard *board)
+{
+    return board->age;
+}
+
+GolStats gol_stats(const GolBoard *board)
+{
+    GolStats stats = { board->generation, 0, board->step_ms };
+    if(board->cells_stale)
+    {
+        stats.population = gen_board_population(&board->gen);
+        return stats;
+    }
+    size_t cells = (size_t)board->w * board->h;
+    for(size_t i = 0 ; i < cells ; i++)
+        stats.population += board->cells[i];
+    return stats;
+}
+
+void gol_history_enable(GolBoard *board, size_t budget, int keyframe_interval)
+{
+    cells_sync(board);
+    history_free(&board->history);
+    history_init(&board->history, (size_t)board->w * board->h, budget, keyframe_interval);
+    board->history_enabled = true;
+}
+
+int gol_history_count(const GolBoard *board)
+{
+    return board->history.count;
+}
+
+int gol_history_cursor(const GolBoard *board)
+{
+    return board->history.cursor;
+}
+
+void gol_history_seek(GolBoard *board, int index)
+{
+    History *history = &board->history;
+    if(history->count == 0 || index < 0 || index >= history->count)
+        return;
+    
+    cells_sync(board);
+    history_seek(history, board->cells, index);
+    if(board->gen.plane[0] != NULL)
+    {
+        // the history only holds live cells, the dying ones are dropped
+        board_planes_init(board);
+    }
+    board->generation = history->entries[history->cursor].generation;
+    // the history doesn't keep ages, they start over from the cells that are alive
+    if(board->age != NULL)
+        for(size_t i = 0 ; i < (size_t)board->w * board->h ; i++)
+            board->age[i] = board->cells[i];
+    memset(board->dirty, true, (size_t)((board->w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE) * ((board->h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE));
+}
+
+GolLenia gol_lenia(const GolBoard *board)
+{
+    return board->lenia_params;
+}
+
+void gol_set_lenia(GolBoard *board, GolLenia lenia)
+{
+    // at radius 1 no sample falls inside the ring and the kernel would be all zeros
+    if(lenia.radius < 2)
+        lenia.radius = 2;
+    board->lenia_params = lenia;
+    
+    if(board->lenia.cells == NULL)
+        return;
+    board->lenia.mu = lenia.mu;
+    board->lenia.sigma = lenia.sigma;
+    board->lenia.dt = lenia.dt;
+    if(board->lenia.radius != lenia.radius)
+    {
+        board->lenia.radius = lenia.radius;
+        lenia_kernel(&board->lenia);
+    }
+}
+
+// edits and history seeks only touch the cells, they're carried over here
+const float *gol_lenia_cells(GolBoard *board)
+{
+    if(board->lenia.cells == NULL && !lenia_init(&board->lenia, board->w, board->h, board->lenia_params))
+        return NULL;
+    cells_sync(board);
+    lenia_sync(&board->lenia, board->cells);
+    return board->lenia.cells;
+}
+
+// random values in a size x size square centred on (x, y).
+// binary noise dies out under most growth functions, a patch of values doesn't.
+void gol_lenia_seed(GolBoard *board, int x, int y, int size)
+{
+    cells_sync(board);
+    Lenia *lenia = &board->lenia;
+    if(lenia->cells == NULL && !lenia_init(lenia, board->w, board->h, board->lenia_params))
+        return;
+    
+    for(int i = 0 ; i < size ; i++)
+    {
+        for(int j = 0 ; j < size ; j++)
+        {
+            int index = gol_wrap(y - size / 2 + i, lenia->h) * lenia->w + gol_wrap(x - size / 2 + j, lenia->w);
+            lenia->cells[index] = (float)rand() / RAND_MAX;
+            board->cells[index] = lenia->cells[index] >= 0.5f;
+        }
+    }
+    gol_cells_changed(board, 0, 0, board->w - 1, board->h - 1);
+}
+
+GolBoard *gol_load_pbm(const char *path, const char *rule)
+{
+    BoardFile bf;
+    if(!board_file_open(&bf, path))
+        return NULL;
+    
+    GolBoard *board = gol_create(bf.w, bf.h, rule);
+    if(board != NULL)
+        for(int y = 0 ; y < bf.h ; y++)
+            board_file_row(&bf, y, board->cells + (size_t)y * bf.w);
+    
+    board_file_close(&bf);
+    return board;
+}
+
+bool gol_save_pbm(const GolBoard *board, const char *path)
+{
+    cells_sync(board);
+    return pbm_write(path, board->cells, board->w, board->h);
+}
+
+char *gol_export_rle(const GolBoard *board)
+{
+    GolPattern pattern = gol_pattern_from_board(board, 0, 0, board->w, board->h);
+    char *text = gol_pattern_to_rle(&pattern, board->rule.name);
+    gol_pattern_free(&pattern);
+    return text;
+}
+
+static Neighbors get_neighbors(const bool *board, int w, int h, int x, int y)
+{
+    Neighbors ret = { 0 };
+    
+    int y_from_bottom     = h - y;
+    int x_from_right      = w - x;
+    
+    int top_neighbor_y    = h - (y_from_bottom % h) - 1;
+    int bottom_neighbor_y = (y + 1) % h;
+    int right_neighbor_x  = (x + 1) % w;
+    int left_neighbor_x   = w - (x_from_right % w) - 1;
+    
+    ret.n1 = board[top_neighbor_y * w + x];
+    ret.n2 = board[top_neighbor_y * w + right_neighbor_x];
+    ret.n3 = board[y * w + right_neighbor_x];
+    ret.n4 = board[bottom_neighbor_y * w + right_neighbor_x];
+    ret.n5 = board[bottom_neighbor_y * w + x];
+    ret.n6 = board[bottom_neighbor_y * w + left_neighbor_x];
+    ret.n7 = board[y * w + left_neighbor_x];
+    ret.n8 = board[top_neighbor_y * w + left_neighbor_x];
+    
+    return ret;
+}
+
+static bool new_state(const Rule *rule, bool is_alive, Neighbors nbrs)
+{
+    union {
+        Neighbors nbrs;
+        unsigned char c;
+    } nbrs_u8;
+    nbrs_u8.nbrs = nbrs;
+    
+    int count =
+#ifdef _MSC_VER
+__popcnt(nbrs_u8.c);
+#else
+__builtin_popcount(nbrs_u8.c);
+#endif
+    
+    return rule_apply(rule, is_alive, count);
+}
+
+static bool rule_apply(const Rule *rule, bool is_alive, int count)
+{
+    return is_alive ? rule->survive[count] : rule->birth[count];
+}
+
+static const char *parse_counts(const char *text, bool *counts, int max)
+{
+    while(*text >= '0' && *text <= '9')
+    {
+        if(*text - '0' <= max)
+            counts[*text - '0'] = true;
+        text++;
+    }
+    return text;
+}
+
+// life-like rules: "B3/S23", "23/3" (survive/birth), with a trailing 'V' for the
+// von Neumann or 'H' for the hexagonal neighbourhood ("B2/S34H").
+// generations: "B2/S/C3", "345/2/4" (number of states last, Moore only).
+// larger than life: "R5,C0,M1,S34..58,B34..45,NM" (Moore neighbourhood of range R,
+// M1 meaning the counts include the cell itself).
+static bool rule_parse(const char *text, Rule *out)
+{
+    Rule parsed = { 0 };
+    snprintf(parsed.name, sizeof(parsed.name), "%s", text);
+    parsed.neighborhood = MOORE;
+    parsed.radius = 1;
+    parsed.states = 2;
+    
+    if(text[0] == 'R' || text[0] == 'r')
+    {
+        int r, c, m, s0, s1, b0, b1;
+        char n;
+        if(sscanf(text + 1, "%d,C%d,M%d,S%d..%d,B%d..%d,N%c", &r, &c, &m, &s0, &s1, &b0, &b1, &n) != 8)
+            return false;
+        if(r < 1 || r > MAX_RADIUS || c > 2 || n != 'M')
+            return false;
+        
+        parsed.radius = r;
+        int max = (2 * r + 1) * (2 * r + 1) - 1;
+        for(int i = 0 ; i <= max ; i++)
+        {
+            parsed.birth[i] = i >= b0 && i <= b1;
+            parsed.survive[i] = i + m >= s0 && i + m <= s1;
+        }
+    }
+    else
+    {
+        bool *first = parsed.survive;
+        bool *second = parsed.birth;
+        const char *p = text;
+        if(*p == 'B' || *p == 'b')
+        {
+            first = parsed.birth;
+            second = parsed.survive;
+            p++;
+        }
+        
+        p = parse_counts(p, first, 8);
+        if(*p != '/')
+            return false;
+        p++;
+        if(*p == 'S' || *p == 's' || *p == 'B' || *p == 'b')
+            p++;
+        p = parse_counts(p, second, 8);
+        
+        // generations: "B2/S/C3" or "2/3/3"
+        if(*p == '/')
+        {
+            p++;
+            if(*p == 'C' || *p == 'c')
+                p++;
+            char *end;
+            parsed.states = strtol(p, &end, 10);
+            if(end == p || parsed.states < 2 || parsed.states > 16)
+                return false;
+            p = end;
+        }
+        
+        if(*p == 'V' || *p == 'v')
+        {
+            parsed.neighborhood = VON_NEUMANN;
+            p++;
+        }
+        else if(*p == 'H' || *p == 'h')
+        {
+            parsed.neighborhood = HEX;
+            p++;
+        }
+        if(*p != '\0' || (parsed.states > 2 && parsed.neighborhood != MOORE))
+            return false;
+        
+        parsed.conway = parsed.neighborhood == MOORE && parsed.states == 2;
+        for(int i = 0 ; i <= 8 ; i++)
+            parsed.conway = parsed.conway && parsed.birth[i] == (i == 3) && parsed.survive[i] == (i == 2 || i == 3);
+    }
+    
+    *out = parsed;
+    return true;
+}
+
+// advances up to `k` generations from board->cells into board->next with the board's
+// engine, or the one its rule needs, returns how many it did
+static int step_board(GolBoard *board, int k)
+{
+    const Rule *rule = &board->rule;
+    const bool *src = board->cells;
+    bool *dst = board->next;
+    int w = board->w;
+    int h = board->h;
+    size_t tiles = (size_t)((w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE) * ((h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE);
+    
+    if(board->engine == GOL_ENGINE_LENIA)
+    {
+        lenia_step(&board->lenia, src, dst);
+        memset(board->dirty, true, tiles);
+        return 1;
+    }
+    
+    if(board_on_planes(board))
+    {
+        // the history and the ages look at every generation, anything else unpacks when it reads
+        step_generations(rule, &board->gen);
+        if(board->history_enabled || board->age != NULL)
+            gen_board_unpack(&board->gen, dst);
+        board->cells_stale = !board->history_enabled && board->age == NULL;
+        memset(board->dirty, true, tiles);
+        return 1;
+    }
+    
+    if(board->engine == GOL_ENGINE_REFERENCE)
+    {
+        step_reference(rule, src, dst, w, h);
+        memset(board->dirty, true, tiles);
+        return 1;
+    }
+    
+    if(rule->neighborhood == MOORE && rule->radius == 1)
+    {
+        step_tiled(rule, src, dst, w, h, k, board->dirty, board->threads);
+        return k;
+    }
+    
+    step_neighborhood(rule, src, dst, w, h);
+    memset(board->dirty, true, tiles);
+    return 1;
+}
+
+// one generation for the neighbourhoods step_tiled() doesn't cover.
+// range-r Moore counts come from a summed-area table of the board padded by r cells
+// on each side (wrapping around), so every cell costs four lookups whatever the radius.
+static void step_neighborhood(const Rule *rule, const bool *src, bool *dst, int w, int h)
+{
+    if(rule->neighborhood == VON_NEUMANN || rule->neighborhood == HEX)
+    {
+        for(int y = 0 ; y < h ; y++)
+        {
+            const bool *up   = src + gol_wrap(y - 1, h) * w;
+            const bool *mid  = src + y * w;
+            const bool *down = src + gol_wrap(y + 1, h) * w;
+            
+            for(int x = 0 ; x < w ; x++)
+            {
+                int left  = x == 0 ? w - 1 : x - 1;
+                int right = x == w - 1 ? 0 : x + 1;
+                int count = up[x] + mid[left] + mid[right] + down[x];
+                
+                // hexagonal cells on a skewed grid: the row above leans right, the row below left
+                if(rule->neighborhood == HEX)
+                    count += up[right] + down[left];
+                
+                dst[y * w + x] = rule_apply(rule, mid[x], count);
+            }
+        }
+        return;
+    }
+    
+    int r = rule->radius;
+    int pw = w + 2 * r;
+    int ph = h + 2 * r;
+    size_t stride = pw + 1;
+    int32_t *sat = malloc(stride * (ph + 1) * sizeof(int32_t));
+    
+    memset(sat, 0, stride * sizeof(int32_t));
+    for(int i = 0 ; i < ph ; i++)
+    {
+        const bool *row = src + gol_wrap(i - r, h) * w;
+        int32_t *above = sat + i * stride;
+        int32_t *out = sat + (i + 1) * stride;
+        int32_t row_sum = 0;
+        
+        out[0] = 0;
+        for(int j = 0 ; j < pw ; j++)
+        {
+            row_sum += row[gol_wrap(j - r, w)];
+            out[j + 1] = above[j + 1] + row_sum;
+        }
+    }
+    
+    int side = 2 * r + 1;
+    for(int y = 0 ; y < h ; y++)
+    {
+        const int32_t *top = sat + y * stride;
+        const int32_t *bottom = sat + (y + side) * stride;
+        
+        for(int x = 0 ; x < w ; x++)
+        {
+            bool alive = src[y * w + x];
+            int count = bottom[x + side] - bottom[x] - top[x + side] + top[x] - alive;
+            dst[y * w + x] = rule_apply(rule, alive, count);
+        }
+    }
+    
+    free(sat);
+}
+
+static void gen_board_init(GenBoard *gb, int w, int h, int states)
+{
+    memset(gb, 0, sizeof(*gb));
+    gb->w = w;
+    gb->h = h;
+    gb->stride = (w + 63) / 64;
+    gb->planes = states <= 4 ? 2 : 4;
+    
+    size_t words = (size_t)gb->stride * h;
+    for(int p = 0 ; p < gb->planes ; p++)
+        gb->plane[p] = calloc(words, sizeof(uint64_t));
+    gb->alive = calloc(words, sizeof(uint64_t));
+    gb->west  = calloc(words, sizeof(uint64_t));
+    gb->east  = calloc(words, sizeof(uint64_t));
+}
+
+static void gen_board_free(GenBoard *gb)
+{
+    for(int p = 0 ; p < gb->planes ; p++)
+        free(gb->plane[p]);
+    free(gb->alive);
+    free(gb->west);
+    free(gb->east);
+    memset(gb, 0, sizeof(*gb));
+}
+
+static int gen_board_get(const GenBoard *gb, int x, int y)
+{
+    size_t word = (size_t)y * gb->stride + x / 64;
+    int state = 0;
+    for(int p = 0 ; p < gb->planes ; p++)
+        state |= ((gb->plane[p][word] >> (x % 64)) & 1) << p;
+    return state;
+}
+
+// packs the rectangle x0..x1, y0..y1 of the bool board into the planes: cells made alive
+// become state 1, live cells that were erased become 0. dying cells are left alone.
+static void gen_board_sync(GenBoard *gb, const bool *board, int x0, int y0, int x1, int y1)
+{
+    for(int y = y0 ; y <= y1 ; y++)
+    {
+        for(int i = x0 / 64 ; i <= x1 / 64 ; i++)
+        {
+            int from = i * 64 > x0 ? i * 64 : x0;
+            int to = i * 64 + 63 < x1 ? i * 64 + 63 : x1;
+            uint64_t alive = 0;
+            uint64_t mask = 0;
+            for(int x = from ; x <= to ; x++)
+            {
+                alive |= (uint64_t)board[y * gb->w + x] << (x % 64);
+                mask |= (uint64_t)1 << (x % 64);
+            }
+            
+            size_t word = (size_t)y * gb->stride + i;
+            uint64_t is_one = gb->plane[0][word];
+            for(int p = 1 ; p < gb->planes ; p++)
+                is_one &= ~gb->plane[p][word];
+            
+            uint64_t born = alive & ~is_one;
+            uint64_t erased = ~alive & is_one & mask;
+            gb->plane[0][word] = (gb->plane[0][word] & ~erased) | born;
+            for(int p = 1 ; p < gb->planes ; p++)
+                gb->plane[p][word] &= ~born;
+        }
+    }
+}
+
+// the live cells of the planes as one bool per cell, 8 cells per store
+static void gen_board_unpack(const GenBoard *gb, bool *board)
+{
+    for(int y = 0 ; y < gb->h ; y++)
+    {
+        bool *row = board + (size_t)y * gb->w;
+        for(int i = 0 ; i < gb->stride ; i++)
+        {
+            size_t word = (size_t)y * gb->stride + i;
+            uint64_t one = gb->plane[0][word];
+            for(int p = 1 ; p < gb->planes ; p++)
+                one &= ~gb->plane[p][word];
+            
+            for(int x = i * 64 ; x < i * 64 + 64 && x < gb->w ; x += 8)
+            {
+                uint64_t cells = expand_byte(one >> (x % 64));
+                if(x + 8 <= gb->w)
+                    memcpy(row + x, &cells, 8);
+                else
+                    memcpy(row + x, &cells, gb->w - x);
+            }
+        }
+    }
+}
+
+static long gen_board_population(const GenBoard *gb)
+{
+    long population = 0;
+    size_t words = (size_t)gb->stride * gb->h;
+    for(size_t word = 0 ; word < words ; word++)
+    {
+        uint64_t one = gb->plane[0][word];
+        for(int p = 1 ; p < gb->planes ; p++)
+            one &= ~gb->plane[p][word];
+#ifdef _MSC_VER
+        population += __popcnt64(one);
+#else
+        population += __builtin_popcountll(one);
+#endif
+    }
+    return population;
+}
+
+// one generation on the bit planes, 64 cells per word operation. the live plane and
+// its copies shifted one cell west / east (wrapping around) are built first, then the
+// eight neighbour words of each word are added into a 4 bit count, also bit-sliced.
+static void step_generations(const Rule *rule, GenBoard *gb)
+{
+    int w = gb->w;
+    int stride = gb->stride;
+    int last = stride - 1;
+    int last_bit = (w - 1) % 64;
+    uint64_t last_mask = last_bit == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (last_bit + 1)) - 1;
+    
+    for(int y = 0 ; y < gb->h ; y++)
+    {
+        uint64_t *alive = gb->alive + (size_t)y * stride;
+        for(int i = 0 ; i < stride ; i++)
+        {
+            size_t word = (size_t)y * stride + i;
+            uint64_t a = gb->plane[0][word];
+            for(int p = 1 ; p < gb->planes ; p++)
+                a &= ~gb->plane[p][word];
+            alive[i] = a;
+        }
+        
+        uint64_t *west = gb->west + (size_t)y * stride;
+        uint64_t *east = gb->east + (size_t)y * stride;
+        for(int i = 0 ; i < stride ; i++)
+        {
+            // west[x] = alive[x - 1], east[x] = alive[x + 1]
+            west[i] = (alive[i] << 1) | (i > 0 ? alive[i - 1] >> 63 : (alive[last] >> last_bit) & 1);
+            east[i] = (alive[i] >> 1) | (i < last ? alive[i + 1] << 63 : 0);
+        }
+        east[last] |= (alive[0] & 1) << last_bit;
+        west[last] &= last_mask;
+    }
+    
+    for(int y = 0 ; y < gb->h ; y++)
+    {
+        size_t up   = (size_t)gol_wrap(y - 1, gb->h) * stride;
+        size_t mid  = (size_t)y * stride;
+        size_t down = (size_t)gol_wrap(y + 1, gb->h) * stride;
+        
+        for(int i = 0 ; i < stride ; i++)
+        {
+            uint64_t neighbors[8] = {
+                gb->west[up + i],   gb->alive[up + i],   gb->east[up + i],
+                gb->west[mid + i],                       gb->east[mid + i],
+                gb->west[down + i], gb->alive[down + i], gb->east[down + i],
+            };
+            
+            uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for(int n = 0 ; n < 8 ; n++)
+            {
+                uint64_t c0 = s0 & neighbors[n];
+                s0 ^= neighbors[n];
+                uint64_t c1 = s1 & c0;
+                s1 ^= c0;
+                uint64_t c2 = s2 & c1;
+                s2 ^= c1;
+                s3 |= c2;
+            }
+            
+            uint64_t birth = 0;
+            uint64_t survive = 0;
+            for(int c = 0 ; c <= 8 ; c++)
+            {
+                if(!rule->birth[c] && !rule->survive[c])
+                    continue;
+                uint64_t eq = (c & 1 ? s0 : ~s0) & (c & 2 ? s1 : ~s1) & (c & 4 ? s2 : ~s2) & (c & 8 ? s3 : ~s3);
+                if(rule->birth[c])
+                    birth |= eq;
+                if(rule->survive[c])
+                    survive |= eq;
+            }
+            
+            size_t word = mid + i;
+            uint64_t any = 0;
+            for(int p = 0 ; p < gb->planes ; p++)
+                any |= gb->plane[p][word];
+            uint64_t is_one = gb->alive[word];
+            uint64_t dying = any & ~is_one;
+            
+            // dying cells and live cells that don't survive count up by one, wrapping to 0 at `states`
+            uint64_t counting = dying | (is_one & ~survive);
+            uint64_t carry = counting;
+            uint64_t next[4] = { 0 };
+            uint64_t at_states = counting;
+            for(int p = 0 ; p < gb->planes ; p++)
+            {
+                uint64_t bit = gb->plane[p][word];
+                next[p] = bit ^ carry;
+                carry = bit & carry;
+                at_states &= rule->states & (1 << p) ? next[p] : ~next[p];
+            }
+            
+            uint64_t keep = counting & ~at_states;
+            uint64_t become_one = (is_one & survive) | (~any & birth);
+            
+            gb->plane[0][word] = ((next[0] & keep) | become_one) & (i == last ? last_mask : ~(uint64_t)0);
+            for(int p = 1 ; p < gb->planes ; p++)
+                gb->plane[p][word] = next[p] & keep;
+        }
+    }
+}
+
+int gol_state(const GolBoard *board, int x, int y)
+{
+    x = gol_wrap(x, board->w);
+    y = gol_wrap(y, board->h);
+    if(board_on_planes(board))
+        return gen_board_get(&board->gen, x, y);
+    return board->cells[y * board->w + x];
+}
+
+// plain product, without the inf / nan recovery of the `*` operator
+static float complex complex_mul(float complex a, float complex b)
+{
+    return CMPLXF(crealf(a) * crealf(b) - cimagf(a) * cimagf(b), crealf(a) * cimagf(b) + cimagf(a) * crealf(b));
+}
+
+static bool fft_init(Fft *fft, int n)
+{
+    fft->n = n;
+    fft->roots = malloc(n * sizeof(float complex));
+    fft->scratch = malloc(n * sizeof(float complex));
+    if(fft->roots == NULL || fft->scratch == NULL)
+        return false;
+    for(int i = 0 ; i < n ; i++)
+        fft->roots[i] = cexp(-2 * 3.14159265358979323846 * I * (double)i / n);
+    return true;
+}
+
+static void fft_free(Fft *fft)
+{
+    free(fft->roots);
+    free(fft->scratch);
+    memset(fft, 0, sizeof(*fft));
+}
+
+// forward transform of the `n` values at in[0], in[stride], ... into out[0..n-1].
+// `step` is fft->n / n, the stride through the roots for this length.
+// n = p * m: the p interleaved subsequences are transformed into the p blocks of out,
+// then each group of p values {out[k], out[k + m], ...} is combined with a size p DFT.
+static void fft_run(Fft *fft, const float complex *in, int stride, float complex *out, int n, int step)
+{
+    if(n == 1)
+    {
+        out[0] = in[0];
+        return;
+    }
+    
+    int p = n;
+    for(int f = 2 ; f * f <= n ; f++)
+    {
+        if(n % f == 0)
+        {
+            p = f;
+            break;
+        }
+    }
+    int m = n / p;
+    
+    for(int q = 0 ; q < p ; q++)
+        fft_run(fft, in + q * stride, stride * p, out + q * m, m, step * p);
+    
+    if(p == 2)
+    {
+        for(int k = 0 ; k < m ; k++)
+        {
+            float complex even = out[k];
+            float complex odd = complex_mul(out[k + m], fft->roots[k * step]);
+            out[k] = even + odd;
+            out[k + m] = even - odd;
+        }
+        return;
+    }
+    
+    float complex *group = fft->scratch;
+    for(int k = 0 ; k < m ; k++)
+    {
+        for(int q = 0 ; q < p ; q++)
+            group[q] = out[q * m + k];
+        
+        for(int s = 0 ; s < p ; s++)
+        {
+            int index = k + s * m;
+            float complex sum = group[0];
+            int exponent = 0;
+            for(int q = 1 ; q < p ; q++)
+            {
+                exponent += index;
+                if(exponent >= n)
+                    exponent -= n;
+                sum += complex_mul(group[q], fft->roots[exponent * step]);
+            }
+            out[index] = sum;
+        }
+    }
+}
+
+// in place, rows then columns. the inverse isn't scaled by 1 / (w * h).
+static void fft_2d(Lenia *lenia, float complex *data, bool inverse)
+{
+    int w = lenia->w;
+    int h = lenia->h;
+    if(inverse)
+        for(int i = 0 ; i < w * h ; i++)
+            data[i] = conjf(data[i]);
+    
+    for(int y = 0 ; y < h ; y++)
+    {
+        fft_run(&lenia->fft_x, data + y * w, 1, lenia->line, w, 1);
+        memcpy(data + y * w, lenia->line, w * sizeof(float complex));
+    }
+    for(int x = 0 ; x < w ; x++)
+    {
+        fft_run(&lenia->fft_y, data + x, w, lenia->line, h, 1);
+        for(int y = 0 ; y < h ; y++)
+            data[y * w + x] = lenia->line[y];
+    }
+    
+    if(inverse)
+        for(int i = 0 ; i < w * h ; i++)
+            data[i] = conjf(data[i]);
+}
+
+static bool lenia_init(Lenia *lenia, int w, int h, GolLenia params)
+{
+    memset(lenia, 0, sizeof(*lenia));
+    lenia->w = w;
+    lenia->h = h;
+    lenia->radius = params.radius;
+    lenia->mu = params.mu;
+    lenia->sigma = params.sigma;
+    lenia->dt = params.dt;
+    lenia->cells = calloc((size_t)w * h, sizeof(float));
+    lenia->kernel = malloc((size_t)w * h * sizeof(float complex));
+    lenia->field = malloc((size_t)w * h * sizeof(float complex));
+    lenia->line = malloc((w > h ? w : h) * sizeof(float complex));
+    bool ok = fft_init(&lenia->fft_x, w);
+    ok = fft_init(&lenia->fft_y, h) && ok;
+    if(!ok || lenia->cells == NULL || lenia->kernel == NULL || lenia->field == NULL || lenia->line == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "LENIA: out of memory for a %dx%d board", w, h);
+        lenia_free(lenia);
+        return false;
+    }
+    
+    // every prime factor p of a side costs a p point DFT per output, a prime side is O(n^2)
+    for(int side = 0 ; side < 2 ; side++)
+    {
+        int n = side == 0 ? w : h;
+        int p = n;
+        for(int f = 2 ; f * f <= p ; f++)
+            while(p % f == 0 && p > f)
+                p /= f;
+        if(p > 64)
+            gol_log(GOL_LOG_WARNING, "LENIA: %s %d has the prime factor %d, the FFT slows down to a plain DFT over it", side == 0 ? "width" : "height", n, p);
+    }
+    lenia_kernel(lenia);
+    return true;
+}
+
+static void lenia_free(Lenia *lenia)
+{
+    free(lenia->cells);
+    free(lenia->kernel);
+    free(lenia->field);
+    free(lenia->line);
+    fft_free(&lenia->fft_x);
+    fft_free(&lenia->fft_y);
+    memset(lenia, 0, sizeof(*lenia));
+}
+
+// the ring exp(4 - 1 / (r (1 - r))) for r = distance / radius in (0, 1), normalized to
+// sum to 1 and centred on cell (0, 0) so the product of the transforms is the convolution
+static void lenia_kernel(Lenia *lenia)
+{
+    int w = lenia->w;
+    int h = lenia->h;
+    int radius = lenia->radius;
+    memset(lenia->kernel, 0, (size_t)w * h * sizeof(float complex));
+    
+    double total = 0;
+    for(int dy = -radius ; dy <= radius ; dy++)
+    {
+        for(int dx = -radius ; dx <= radius ; dx++)
+        {
+            double r = sqrt(dx * dx + dy * dy) / radius;
+            if(r <= 0 || r >= 1)
+                continue;
+            double value = exp(4 - 1 / (r * (1 - r)));
+            lenia->kernel[gol_wrap(dy, h) * w + gol_wrap(dx, w)] += value;
+            total += value;
+        }
+    }
+    for(int i = 0 ; i < w * h ; i++)
+        lenia->kernel[i] /= total;
+    
+    fft_2d(lenia, lenia->kernel, false);
+}
+
+// cells that were switched on or off on the bool board take the value 1 or 0
+static void lenia_sync(Lenia *lenia, const bool *board)
+{
+    for(int i = 0 ; i < lenia->w * lenia->h ; i++)
+        if(board[i] != (lenia->cells[i] >= 0.5f))
+            lenia->cells[i] = board[i];
+}
+
+static void lenia_step(Lenia *lenia, const bool *src, bool *dst)
+{
+    int cells = lenia->w * lenia->h;
+    lenia_sync(lenia, src);
+    
+    for(int i = 0 ; i < cells ; i++)
+        lenia->field[i] = lenia->cells[i];
+    fft_2d(lenia, lenia->field, false);
+    for(int i = 0 ; i < cells ; i++)
+        lenia->field[i] = complex_mul(lenia->field[i], lenia->kernel[i]);
+    fft_2d(lenia, lenia->field, true);
+    
+    // growth is a gaussian bump around mu, from -1 far away to +1 at mu
+    float scale = 1.0f / cells;
+    float spread = 2 * lenia->sigma * lenia->sigma;
+    for(int i = 0 ; i < cells ; i++)
+    {
+        float u = crealf(lenia->field[i]) * scale - lenia->mu;
+        float growth = 2 * expf(-u * u / spread) - 1;
+        lenia->cells[i] = fminf(fmaxf(lenia->cells[i] + lenia->dt * growth, 0), 1);
+        dst[i] = lenia->cells[i] >= 0.5f;
+    }
+}
+
+// the original one cell at a time stepper, kept as the reference the other engines are checked against
+static void step_reference(const Rule *rule, const bool *src, bool *dst, int w, int h)
+{
+    for(int i = 0 ; i < h ; i++)
+    {
+        for(int j = 0 ; j < w ; j++)
+        {
+            bool cell_state = src[i * w + j];
+            Neighbors nbors = get_neighbors(src, w, h, j, i);
+            bool next_cell_state = new_state(rule, cell_state, nbors);
+            dst[i * w + j] = next_cell_state;
+        }
+    }
+}
+
+// one cell at a time for every rule: Moore of any range, von Neumann, hexagonal and the
+// dying states of generations rules. checks the rules step_reference doesn't run.
+static void step_reference_states(const Rule *rule, const unsigned char *src, unsigned char *dst, int w, int h)
+{
+    static const int von_neumann[][2] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+    static const int hex[][2] = { { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 } };
+    int r = rule->radius;
+    
+    for(int y = 0 ; y < h ; y++)
+    {
+        for(int x = 0 ; x < w ; x++)
+        {
+            int count = 0;
+            if(rule->neighborhood == MOORE)
+            {
+                for(int dy = -r ; dy <= r ; dy++)
+                    for(int dx = -r ; dx <= r ; dx++)
+                        if(dx != 0 || dy != 0)
+                            count += src[gol_wrap(y + dy, h) * w + gol_wrap(x + dx, w)] == 1;
+            }
+            else
+            {
+                const int (*offsets)[2] = rule->neighborhood == HEX ? hex : von_neumann;
+                int n = rule->neighborhood == HEX ? 6 : 4;
+                for(int i = 0 ; i < n ; i++)
+                    count += src[gol_wrap(y + offsets[i][1], h) * w + gol_wrap(x + offsets[i][0], w)] == 1;
+            }
+            
+            int state = src[y * w + x];
+            if(state == 0)
+                dst[y * w + x] = rule->birth[count];
+            else if(state == 1 && rule->survive[count])
+                dst[y * w + x] = 1;
+            else
+                dst[y * w + x] = state + 1 == rule->states ? 0 : state + 1;
+        }
+    }
+}
+
+// advances `k` generations from src into dst.
+// every GOL_TILE_SIZE tile is loaded with a k cell halo (wrapped around the edges),
+// stepped k times in place while the valid region shrinks by one cell per generation,
+// and written back once. the halo is recomputed by the neighbouring tiles,
+// but the whole board is only read and written once per k generations.
+// tiles that differ from src are flagged in `dirty` (GOL_TILE_SIZE tiles, row-major) unless it's NULL.
+// rows of tiles are shared out between `threads` threads.
+static void step_tiled(const Rule *rule, const bool *src, bool *dst, int w, int h, int k, bool *dirty, int threads)
+{
+    int tile_rows = (h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE;
+    if(threads > tile_rows)
+        threads = tile_rows;
+    if(threads > GOL_MAX_THREADS)
+        threads = GOL_MAX_THREADS;
+    if(threads < 1)
+        threads = 1;
+    
+    TileJob jobs[GOL_MAX_THREADS];
+    pthread_t ids[GOL_MAX_THREADS];
+    bool started[GOL_MAX_THREADS] = { false };
+    for(int t = 0 ; t < threads ; t++)
+    {
+        jobs[t] = (TileJob){ rule, src, dst, w, h, k < 1 ? 1 : k, dirty, t, threads };
+        if(t > 0)
+            started[t] = pthread_create(&ids[t], NULL, step_tiled_rows, &jobs[t]) == 0;
+    }
+    
+    // rows of a thread that couldn't be created are stepped here instead
+    step_tiled_rows(&jobs[0]);
+    for(int t = 1 ; t < threads ; t++)
+    {
+        if(started[t])
+            pthread_join(ids[t], NULL);
+        else
+            step_tiled_rows(&jobs[t]);
+    }
+}
+
+// one generation of the tile in `a` into `b`, `NEXT` deciding a cell from `alive` and `count`.
+// expanded once with the rule table and once with B3/S23 written out, which
+// lets the compiler turn the lookup into a couple of compares for plain Life.
+#define TILE_GENERATION(NEXT)                                       \
+    for(int i = g ; i < sh - g ; i++)                               \
+    {                                                               \
+        const bool *up   = a + (i - 1) * sw;                        \
+        const bool *mid  = a + i * sw;                              \
+        const bool *down = a + (i + 1) * sw;                        \
+        bool *out = b + i * sw;                                     \
+                                                                    \
+        for(int j = g ; j < sw - g ; j++)                           \
+        {                                                           \
+            bool alive = mid[j];                                    \
+            int count =                                             \
+                up[j - 1]   + up[j]   + up[j + 1] +                 \
+                mid[j - 1]            + mid[j + 1] +                \
+                down[j - 1] + down[j] + down[j + 1];                \
+            out[j] = (NEXT);                                        \
+        }                                                           \
+    }
+
+static void *step_tiled_rows(void *arg)
+{
+    const TileJob *job = arg;
+    const Rule *rule = job->rule;
+    const bool *src = job->src;
+    bool *dst = job->dst;
+    int w = job->w;
+    int h = job->h;
+    int k = job->k;
+    bool *dirty = job->dirty;
+    
+    int span = GOL_TILE_SIZE + 2 * k;
+    bool *a   = malloc(span * span);
+    bool *b   = malloc(span * span);
+    int *cols = malloc(span * sizeof(int));
+    
+    for(int ty = job->first_row * GOL_TILE_SIZE ; ty < h ; ty += job->row_step * GOL_TILE_SIZE)
+    {
+        for(int tx = 0 ; tx < w ; tx += GOL_TILE_SIZE)
+        {
+            int tw = w - tx < GOL_TILE_SIZE ? w - tx : GOL_TILE_SIZE;
+            int th = h - ty < GOL_TILE_SIZE ? h - ty : GOL_TILE_SIZE;
+            int sw = tw + 2 * k;
+            int sh = th + 2 * k;
+            
+            for(int j = 0 ; j < sw ; j++)
+                cols[j] = gol_wrap(tx - k + j, w);
+            
+            for(int i = 0 ; i < sh ; i++)
+            {
+                const bool *row = src + gol_wrap(ty - k + i, h) * w;
+                bool *out = a + i * sw;
+                for(int j = 0 ; j < sw ; j++)
+                    out[j] = row[cols[j]];
+            }
+            
+            for(int g = 1 ; g <= k ; g++)
+            {
+                if(rule->conway)
+                {
+                    TILE_GENERATION(count == 3 || (count == 2 && alive))
+                }
+                else
+                {
+                    TILE_GENERATION(rule_apply(rule, alive, count))
+                }
+                
+                bool *temp = a;
+                a = b;
+                b = temp;
+            }
+            
+            bool changed = false;
+            for(int i = 0 ; i < th ; i++)
+            {
+                const bool *result = a + (i + k) * sw + k;
+                if(dirty != NULL && !changed)
+                    changed = memcmp(src + (ty + i) * w + tx, result, tw) != 0;
+                memcpy(dst + (ty + i) * w + tx, result, tw);
+            }
+            
+            if(changed)
+                dirty[(ty / GOL_TILE_SIZE) * ((w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE) + tx / GOL_TILE_SIZE] = true;
+        }
+    }
+    
+    free(a);
+    free(b);
+    free(cols);
+    return NULL;
+}
+
+// steps a random board `generations` times with the tiled kernel one generation
+// per pass (k = 1) and k generations per pass, and prints the time per generation of each.
+// both runs use the same kernel and threads, so the ratio is what temporal tiling buys.
+int gol_bench(int w, int h, const char *rule_text, int generations, int k, int threads)
+{
+    Rule rule;
+    if(!rule_parse(rule_text, &rule))
+        return 1;
+    if(rule.neighborhood != MOORE || rule.radius != 1 || rule.states > 2)
+    {
+        gol_log(GOL_LOG_ERROR, "BENCH: only two state rules on the 8 cell Moore neighbourhood can be benchmarked");
+        return 1;
+    }
+    
+    if(k < 1)
+        k = 1;
+    if(generations < k)
+        generations = k;
+    generations -= generations % k;
+    
+    size_t size = (size_t)w * h;
+    bool *start   = grid_alloc(size, "bench start");
+    bool *current = grid_alloc(size, "bench grid");
+    bool *other   = grid_alloc(size, "bench grid2");
+    bool *tiled_current = grid_alloc(size, "bench tiled");
+    bool *tiled_other   = grid_alloc(size, "bench tiled2");
+    if(start == NULL || current == NULL || other == NULL || tiled_current == NULL || tiled_other == NULL)
+    {
+        grid_free(start, size);
+        grid_free(current, size);
+        grid_free(other, size);
+        grid_free(tiled_current, size);
+        grid_free(tiled_other, size);
+        return 1;
+    }
+    
+    srand(1);
+    for(size_t i = 0 ; i < size ; i++)
+        start[i] = rand() % 2;
+    
+    memcpy(current, start, size);
+    
+    double begin = now_seconds();
+    for(int g = 0 ; g < generations ; g++)
+    {
+        step_tiled(&rule, current, other, w, h, 1, NULL, threads);
+        bool *temp = current;
+        current = other;
+        other = temp;
+    }
+    double single_time = now_seconds() - begin;
+    
+    memcpy(tiled_current, start, size);
+    
+    begin = now_seconds();
+    for(int g = 0 ; g < generations ; g += k)
+    {
+        step_tiled(&rule, tiled_current, tiled_other, w, h, k, NULL, threads);
+        bool *temp = tiled_current;
+        tiled_current = tiled_other;
+        tiled_other = temp;
+    }
+    double tiled_time = now_seconds() - begin;
+    
+    bool match = memcmp(current, tiled_current, size) == 0;
+    
+    printf("board %dx%d, %d generations, tile %d, k %d, %d threads\n", w, h, generations, GOL_TILE_SIZE, k, threads);
+    printf("k = %-4d %10.3f ms/gen\n", 1, single_time * 1000 / generations);
+    printf("k = %-4d %10.3f ms/gen (%.2fx)\n", k, tiled_time * 1000 / generations, single_time / tiled_time);
+    printf("results %s\n", match ? "match" : "DIFFER");
+    
+    grid_free(start, size);
+    grid_free(current, size);
+    grid_free(other, size);
+    grid_free(tiled_current, size);
+    grid_free(tiled_other, size);
+    
+    return match ? 0 : 1;
+}
+
+// reads the "P4 <w> <h>" header, leaving the file at the first row
+static bool pbm_read_header(FILE *file, int *w, int *h)
+{
+    if(fgetc(file) != 'P' || fgetc(file) != '4')
+        return false;
+    
+    int values[2];
+    for(int i = 0 ; i < 2 ; i++)
+    {
+        int c = fgetc(file);
+        while(c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#')
+        {
+            if(c == '#')
+                while(c != '\n' && c != EOF)
+                    c = fgetc(file);
+            c = fgetc(file);
+        }
+        
+        if(c < '0' || c > '9')
+            return false;
+        
+        values[i] = 0;
+        while(c >= '0' && c <= '9')
+        {
+            values[i] = values[i] * 10 + (c - '0');
+            c = fgetc(file);
+        }
+    }
+    
+    // a single whitespace character separates the header from the rows,
+    // and it was consumed by the last fgetc()
+    *w = values[0];
+    *h = values[1];
+    return *w > 0 && *h > 0;
+}
+
+static bool board_file_open(BoardFile *bf, const char *path)
+{
+    memset(bf, 0, sizeof(*bf));
+    
+    bf->file = fopen(path, "rb");
+    if(bf->file == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: could not open %s", path);
+        return false;
+    }
+    if(!pbm_read_header(bf->file, &bf->w, &bf->h))
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: %s is not a binary PBM (P4) file", path);
+        fclose(bf->file);
+        return false;
+    }
+    
+    bf->row_bytes = (bf->w + 7) / 8;
+    bf->data_offset = ftell(bf->file);
+    
+    // a short file would fault on the first mapped read past its end
+    long size = -1;
+    if(fseek(bf->file, 0, SEEK_END) == 0)
+        size = ftell(bf->file);
+    if(size < 0 || (size_t)size < (size_t)bf->data_offset + bf->row_bytes * bf->h)
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: %s is shorter than its %dx%d header says", path, bf->w, bf->h);
+        fclose(bf->file);
+        return false;
+    }
+    
+#if defined(__linux__)
+    bf->map_size = bf->data_offset + bf->row_bytes * bf->h;
+    void *map = mmap(NULL, bf->map_size, PROT_READ, MAP_PRIVATE, fileno(bf->file), 0);
+    if(map != MAP_FAILED)
+    {
+        madvise(map, bf->map_size, MADV_SEQUENTIAL);
+        bf->map = map;
+    }
+#endif
+    
+    if(bf->map == NULL)
+    {
+        bf->row = malloc(bf->row_bytes);
+        if(bf->row == NULL)
+        {
+            gol_log(GOL_LOG_ERROR, "STREAM: can't allocate a row of %s", path);
+            fclose(bf->file);
+            return false;
+        }
+    }
+    return true;
+}
+
+// unpacks row `y` into one bool per cell
+static void board_file_row(BoardFile *bf, int y, bool *out)
+{
+    const unsigned char *row;
+    if(bf->map != NULL)
+    {
+        row = bf->map + bf->data_offset + bf->row_bytes * y;
+    }
+    else
+    {
+        fseek(bf->file, bf->data_offset + (long)bf->row_bytes * y, SEEK_SET);
+        if(fread(bf->row, 1, bf->row_bytes, bf->file) != bf->row_bytes)
+            memset(bf->row, 0, bf->row_bytes);
+        row = bf->row;
+    }
+    
+    for(int x = 0 ; x < bf->w ; x++)
+        out[x] = (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+static void board_file_close(BoardFile *bf)
+{
+#if defined(__linux__)
+    if(bf->map != NULL)
+        munmap((void*)bf->map, bf->map_size);
+#endif
+    free(bf->row);
+    fclose(bf->file);
+}
+
+// computes one generation of the board in `in_path` into `out_path`
+// while holding only three rows in memory: the previous, current and next row.
+// the first row is kept around so the last row can wrap to it.
+static bool stream_generation(const Rule *rule, const char *in_path, const char *out_path)
+{
+    BoardFile in;
+    if(!board_file_open(&in, in_path))
+        return false;
+    
+    FILE *out = fopen(out_path, "wb");
+    if(out == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: could not create %s", out_path);
+        board_file_close(&in);
+        return false;
+    }
+    fprintf(out, "P4\n%d %d\n", in.w, in.h);
+    
+    int w = in.w;
+    bool *first = malloc(w);
+    bool *prev  = malloc(w);
+    bool *cur   = malloc(w);
+    bool *next  = malloc(w);
+    bool *result = malloc(w);
+    unsigned char *packed = malloc(in.row_bytes);
+    if(first == NULL || prev == NULL || cur == NULL || next == NULL || result == NULL || packed == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: can't allocate the rows of %s", in_path);
+        free(first);
+        free(prev);
+        free(cur);
+        free(next);
+        free(result);
+        free(packed);
+        board_file_close(&in);
+        fclose(out);
+        return false;
+    }
+    
+    board_file_row(&in, in.h - 1, prev);
+    board_file_row(&in, 0, first);
+    memcpy(cur, first, w);
+    
+    for(int y = 0 ; y < in.h ; y++)
+    {
+        if(y + 1 < in.h)
+            board_file_row(&in, y + 1, next);
+        else
+            memcpy(next, first, w);
+        
+        for(int x = 0 ; x < w ; x++)
+        {
+            int left  = x == 0 ? w - 1 : x - 1;
+            int right = x == w - 1 ? 0 : x + 1;
+            int count =
+                prev[left] + prev[x] + prev[right] +
+                cur[left]            + cur[right] +
+                next[left] + next[x] + next[right];
+            
+            result[x] = rule_apply(rule, cur[x], count);
+        }
+        pack_row(result, w, packed);
+        fwrite(packed, 1, in.row_bytes, out);
+        
+        bool *temp = prev;
+        prev = cur;
+        cur = next;
+        next = temp;
+    }
+    
+    free(first);
+    free(prev);
+    free(cur);
+    free(next);
+    free(result);
+    free(packed);
+    board_file_close(&in);
+    
+    return fclose(out) == 0;
+}
+
+// every generation is written to a temporary file next to `out_path` and renamed over it,
+// so the file being read is never the one being written, even when in_path is out_path
+bool gol_stream_pbm(const char *rule_text, const char *in_path, const char *out_path, long generations)
+{
+    Rule rule;
+    if(!rule_parse(rule_text, &rule))
+        return false;
+    if(rule.neighborhood != MOORE || rule.radius != 1 || rule.states > 2)
+    {
+        gol_log(GOL_LOG_ERROR, "STREAM: only two state rules on the 8 cell Moore neighbourhood can be streamed");
+        return false;
+    }
+    
+    if(generations < 1)
+        generations = 1;
+    
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", out_path);
+    
+    const char *src = in_path;
+    for(long g = 0 ; g < generations ; g++)
+    {
+        if(!stream_generation(&rule, src, tmp_path))
+        {
+            remove(tmp_path);
+            return false;
+        }
+#if defined(_WIN32)
+        remove(out_path);
+#endif
+        if(rename(tmp_path, out_path) != 0)
+        {
+            gol_log(GOL_LOG_ERROR, "STREAM: could not replace %s", out_path);
+            remove(tmp_path);
+            return false;
+        }
+        src = out_path;
+    }
+    
+    return true;
+}
+
+// writes a whole board as a binary PBM (P4), rows padded to whole bytes
+static bool pbm_write(const char *path, const bool *board, int w, int h)
+{
+    FILE *file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "PBM: could not create %s", path);
+        return false;
+    }
+    fprintf(file, "P4\n%d %d\n", w, h);
+    
+    size_t row_bytes = (w + 7) / 8;
+    unsigned char *packed = malloc(row_bytes);
+    for(int y = 0 ; y < h ; y++)
+    {
+        pack_row(board + (size_t)y * w, w, packed);
+        fwrite(packed, 1, row_bytes, file);
+    }
+    free(packed);
+    
+    return fclose(file) == 0;
+}
+
+// w cells into (w + 7) / 8 bytes, most significant bit first as in PBM files.
+// eight cells are loaded as one word, the multiply moves the low bit of byte i to
+// bit 63 - i without carries, so the top byte is the packed byte.
+static void pack_row(const bool *row, int w, unsigned char *out)
+{
+    int x = 0;
+    for( ; x + 8 <= w ; x += 8)
+    {
+        uint64_t cells;
+        memcpy(&cells, row + x, 8);
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        cells = __builtin_bswap64(cells);
+        #endif
+        out[x >> 3] = (cells * 0x8040201008040201ull) >> 56;
+    }
+    if(x < w)
+        out[x >> 3] = 0;
+    for( ; x < w ; x++)
+        if(row[x])
+            out[x >> 3] |= 0x80 >> (x & 7);
+}
+
+// age = alive ? min(age + 1, 255) : 0, eight cells a word. `full` has the top bit set in
+// every byte that is 255 (the bytes of ~age that are zero, found without borrows between
+// bytes), those aren't incremented, so the add never carries into the next byte.
+static void age_update(unsigned char *age, const bool *cells, size_t count)
+{
+    size_t i = 0;
+    for( ; i + 8 <= count ; i += 8)
+    {
+        uint64_t alive;
+        uint64_t a;
+        memcpy(&alive, cells + i, 8);
+        memcpy(&a, age + i, 8);
+        uint64_t t = ~a;
+        uint64_t full = ~(((t & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | t) & 0x8080808080808080ull;
+        a = (a + (alive & ~(full >> 7))) & (alive * 0xff);
+        memcpy(age + i, &a, 8);
+    }
+    for( ; i < count ; i++)
+        age[i] = cells[i] ? age[i] + (age[i] < 255) : 0;
+}
+
+// the engines `gol verify` checks against the reference. the first ones step the cells
+// directly, from VERIFY_BOARDS on whole boards run through gol_step().
+static const char *verify_engines[] = {
+    "tiled k=1", "tiled k=2", "tiled k=3", "tiled k=5", "neighborhood", "stream", "packed", "auto + ages"
+};
+#define VERIFY_ENGINES (int)(sizeof(verify_engines) / sizeof(verify_engines[0]))
+#define VERIFY_BOARDS 6
+#define VERIFY_AGES 7
+
+// the original stepper for the rules it runs, step_reference_states for the others
+static void verify_reference(const Rule *rule, const unsigned char *src, unsigned char *dst, int w, int h)
+{
+    if(rule->neighborhood != MOORE || rule->radius != 1 || rule->states > 2)
+    {
+        step_reference_states(rule, src, dst, w, h);
+        return;
+    }
+    
+    size_t cells = (size_t)w * h;
+    bool *from = malloc(cells);
+    bool *to = malloc(cells);
+    for(size_t i = 0 ; i < cells ; i++)
+        from[i] = src[i];
+    step_reference(rule, from, to, w, h);
+    for(size_t i = 0 ; i < cells ; i++)
+        dst[i] = to[i];
+    free(from);
+    free(to);
+}
+
+static bool verify_runs(int engine, const Rule *rule)
+{
+    bool moore = rule->neighborhood == MOORE && rule->radius == 1;
+    if(engine < 4 || engine == 5)
+        return moore && rule->states == 2;
+    if(engine == 4)
+        return rule->states == 2;
+    if(engine == 6)
+        return engine_runs(GOL_ENGINE_PACKED, rule);
+    return true;
+}
+
+// advances src into dst with one of verify_engines, returns how many generations it did.
+// the board engines step `board` and read their states back, src is only where they started.
+// the stream engine goes through the two files at `paths`.
+static int verify_step(const Rule *rule, int engine, GolBoard *board, const unsigned char *src, unsigned char *dst, int w, int h, int threads, const char *paths[2])
+{
+    static const int tiled_k[] = { 1, 2, 3, 5 };
+    
+    if(engine >= VERIFY_BOARDS)
+    {
+        // the live cells come from gol_cells() so the cells unpacked from the planes are checked too
+        int steps = gol_step(board, 3);
+        const bool *cells = gol_cells(board);
+        for(int y = 0 ; y < h ; y++)
+        {
+            for(int x = 0 ; x < w ; x++)
+            {
+                int state = gol_state(board, x, y);
+                dst[y * w + x] = cells[y * w + x] ? 1 : state == 1 ? 0 : state;
+            }
+        }
+        return steps;
+    }
+    
+    size_t cells = (size_t)w * h;
+    bool *from = malloc(cells);
+    bool *to = malloc(cells);
+    for(size_t i = 0 ; i < cells ; i++)
+        from[i] = src[i];
+    
+    int steps = 0;
+    switch(engine)
+    {
+        case 0: case 1: case 2: case 3:
+            step_tiled(rule, from, to, w, h, tiled_k[engine], NULL, threads);
+            steps = tiled_k[engine];
+            break;
+        case 4:
+            step_neighborhood(rule, from, to, w, h);
+            steps = 1;
+            break;
+        case 5:
+        {
+            BoardFile bf;
+            if(paths[0] == NULL || paths[1] == NULL ||
+               !pbm_write(paths[0], from, w, h) ||
+               !stream_generation(rule, paths[0], paths[1]) ||
+               !board_file_open(&bf, paths[1]))
+            {
+                break;
+            }
+            for(int y = 0 ; y < h ; y++)
+                board_file_row(&bf, y, to + y * w);
+            board_file_close(&bf);
+            steps = 1;
+            break;
+        }
+    }
+    
+    for(size_t i = 0 ; i < cells ; i++)
+        dst[i] = to[i];
+    free(from);
+    free(to);
+    return steps;
+}
+
+// a board of `rule` starting from `start` on one of the board engines
+static GolBoard *verify_board(const Rule *rule, int engine, const unsigned char *start, int w, int h, int threads)
+{
+    GolBoard *board = gol_create(w, h, rule->name);
+    if(board == NULL)
+        return NULL;
+    
+    bool *cells = gol_cells(board);
+    for(size_t i = 0 ; i < (size_t)w * h ; i++)
+        cells[i] = start[i];
+    gol_cells_changed(board, 0, 0, w - 1, h - 1);
+    gol_set_threads(board, threads);
+    
+    if(!gol_set_engine(board, engine == VERIFY_AGES ? GOL_ENGINE_AUTO : GOL_ENGINE_PACKED) ||
+       (engine == VERIFY_AGES && !gol_set_age(board, true)))
+    {
+        gol_destroy(board);
+        return NULL;
+    }
+    return board;
+}
+
+// runs every engine against the reference on random boards of awkward sizes and several
+// rules, comparing board hashes after every step, and the ages where the engine keeps them.
+// boards are always tori, it's the only boundary there is. prints the first generation and
+// cell of each divergence. the runs are split between `threads` threads, and the tiled and
+// board engines split each of their steps between `threads` threads too.
+int gol_verify(const char *rule_text, int generations, int threads)
+{
+    const char *rules[] = {
+        rule_text, "B3/S23", "B36/S23", "B2/S", "B3678/S34678", "B1357/S1357",
+        "B1/S012V", "B2/S34H", "R2,C0,M1,S4..8,B4..6,NM", "R5,C0,M1,S34..58,B34..45,NM",
+        "B2/S/C3", "345/2/4", "B3/S23/C6"
+    };
+    VerifyJob job = {
+        .rules = rules,
+        .rule_count = sizeof(rules) / sizeof(rules[0]),
+        .generations = generations,
+        .threads = threads < 1 ? 1 : threads,
+    };
+    pthread_mutex_init(&job.lock, NULL);
+    int workers = job.threads > GOL_MAX_THREADS ? GOL_MAX_THREADS : job.threads;
+    
+    // the boards made here would fill the log with their allocations
+    GolLogFunc log_saved = log_func;
+    log_func = NULL;
+    
+    // like step_tiled(), a thread that can't be started leaves its share to the others
+    pthread_t ids[GOL_MAX_THREADS];
+    bool started[GOL_MAX_THREADS] = { false };
+    for(int t = 1 ; t < workers ; t++)
+        started[t] = pthread_create(&ids[t], NULL, verify_worker, &job) == 0;
+    verify_worker(&job);
+    for(int t = 1 ; t < workers ; t++)
+        if(started[t])
+            pthread_join(ids[t], NULL);
+    
+    log_func = log_saved;
+    pthread_mutex_destroy(&job.lock);
+    
+    printf("%d of %d engine runs match the reference over %d generations\n", job.checks - job.failures, job.checks, generations);
+    return job.failures == 0 ? 0 : 1;
+}
+
+// takes runs off `job` until there are none left. each thread streams through its own
+// pair of temporary files, removed again when it's done.
+static void *verify_worker(void *arg)
+{
+    VerifyJob *job = arg;
+    static const int sizes[][2] = { { 100, 100 }, { 64, 64 }, { 63, 17 }, { 65, 33 }, { 130, 70 }, { 200, 3 }, { 7, 129 }, { 3, 3 } };
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+    
+    char in_path[512];
+    char out_path[512];
+    bool have_in = verify_temp_file(in_path, sizeof(in_path));
+    bool have_out = verify_temp_file(out_path, sizeof(out_path));
+    const char *paths[2] = { have_in ? in_path : NULL, have_out ? out_path : NULL };
+    
+    while(true)
+    {
+        pthread_mutex_lock(&job->lock);
+        int next = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if(next >= job->rule_count * size_count)
+            break;
+        
+        int r = next / size_count;
+        int s = next % size_count;
+        Rule rule;
+        if(!rule_parse(job->rules[r], &rule))
+        {
+            if(s == 0)
+                printf("%-14s skipped, not a rule\n", job->rules[r]);
+            continue;
+        }
+        
+        int checks = 0;
+        int failures = verify_run(&rule, job->rules[r], sizes[s][0], sizes[s][1], r * 1000 + s, job->generations, job->threads, paths, &checks);
+        pthread_mutex_lock(&job->lock);
+        job->checks += checks;
+        job->failures += failures;
+        pthread_mutex_unlock(&job->lock);
+    }
+    
+    if(have_in)
+        remove(in_path);
+    if(have_out)
+        remove(out_path);
+    return NULL;
+}
+
+// a new empty file under $TMPDIR for the stream engine, so runs don't leave
+// anything in the working directory and threads don't share files
+static bool verify_temp_file(char *path, size_t size)
+{
+#if defined(_WIN32)
+    const char *dir = getenv("TEMP");
+    snprintf(path, size, "%s\\gol_verify_XXXXXX", dir != NULL ? dir : ".");
+    return _mktemp_s(path, strlen(path) + 1) == 0;
+#else
+    const char *dir = getenv("TMPDIR");
+    snprintf(path, size, "%s/gol_verify_XXXXXX", dir != NULL && dir[0] != '\0' ? dir : "/tmp");
+    int fd = mkstemp(path);
+    if(fd < 0)
+        return false;
+    close(fd);
+    return true;
+#endif
+}
+
+// every engine that runs `rule` (parsed from `rule_text`) against the reference on a random w x h board
+// seeded with `seed`. returns the failures, counting the engines checked into `checks`.
+static int verify_run(const Rule *rule, const char *rule_text, int w, int h, unsigned seed, int generations, int threads, const char *paths[2], int *checks)
+{
+    int failures = 0;
+    
+    size_t cells = (size_t)w * h;
+    unsigned char *start = malloc(cells);
+    unsigned char *expected = malloc(cells);
+    unsigned char *expected_next = malloc(cells);
+    unsigned char *expected_age = malloc(cells);
+    unsigned char *actual = malloc(cells);
+    unsigned char *actual_next = malloc(cells);
+    
+    // not rand(), it's shared between the threads
+    for(size_t i = 0 ; i < cells ; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        start[i] = (seed >> 16) & 1;
+    }
+    
+    for(int e = 0 ; e < VERIFY_ENGINES ; e++)
+    {
+        if(!verify_runs(e, rule))
+            continue;
+        
+        GolBoard *board = NULL;
+        if(e >= VERIFY_BOARDS && (board = verify_board(rule, e, start, w, h, threads)) == NULL)
+        {
+            printf("%-14s %dx%d %s: engine failed\n", rule_text, w, h, verify_engines[e]);
+            failures++;
+            (*checks)++;
+            continue;
+        }
+        memcpy(expected, start, cells);
+        memcpy(expected_age, start, cells);
+        memcpy(actual, start, cells);
+        
+        int g = 0;
+        while(g < generations)
+        {
+            int steps = verify_step(rule, e, board, actual, actual_next, w, h, threads, paths);
+            if(steps == 0)
+            {
+                printf("%-14s %dx%d %s: engine failed\n", rule_text, w, h, verify_engines[e]);
+                failures++;
+                break;
+            }
+            for(int i = 0 ; i < steps ; i++)
+            {
+                verify_reference(rule, expected, expected_next, w, h);
+                unsigned char *temp = expected;
+                expected = expected_next;
+                expected_next = temp;
+                for(size_t c = 0 ; c < cells ; c++)
+                    expected_age[c] = expected[c] == 1 ? expected_age[c] + (expected_age[c] < 255) : 0;
+            }
+            unsigned char *temp = actual;
+            actual = actual_next;
+            actual_next = temp;
+            g += steps;
+            
+            const unsigned char *age = e == VERIFY_AGES ? gol_age(board) : NULL;
+            if(gol_hash(expected, cells) != gol_hash(actual, cells) ||
+               (age != NULL && gol_hash(expected_age, cells) != gol_hash(age, cells)))
+            {
+                size_t i = 0;
+                while(i < cells && expected[i] == actual[i])
+                    i++;
+                if(i < cells)
+                {
+                    printf(
+                        "%-14s %dx%d %s: generation %d differs first at cell (%d, %d), expected %d got %d\n",
+                        rule_text, w, h, verify_engines[e], g, (int)(i % w), (int)(i / w), expected[i], actual[i]
+                    );
+                }
+                else
+                {
+                    i = 0;
+                    while(expected_age[i] == age[i])
+                        i++;
+                    printf(
+                        "%-14s %dx%d %s: generation %d age differs first at cell (%d, %d), expected %d got %d\n",
+                        rule_text, w, h, verify_engines[e], g, (int)(i % w), (int)(i / w), expected_age[i], age[i]
+                    );
+                }
+                failures++;
+                break;
+            }
+        }
+        
+        gol_destroy(board);
+        (*checks)++;
+    }
+    
+    free(start);
+    free(expected);
+    free(expected_next);
+    free(expected_age);
+    free(actual);
+    free(actual_next);
+    return failures;
+}
+
+static void history_init(History *history, size_t cells, size_t budget, int keyframe_interval)
+{
+    memset(history, 0, sizeof(*history));
+    history->cells = cells;
+    history->budget = budget;
+    history->keyframe_interval = keyframe_interval < 1 ? 1 : keyframe_interval;
+}
+
+static void history_free(History *history)
+{
+    for(int i = 0 ; i < history->count ; i++)
+    {
+        free(history->entries[i].delta);
+        free(history->entries[i].keyframe);
+    }
+    free(history->entries);
+    memset(history, 0, sizeof(*history));
+}
+
+static size_t history_entry_bytes(const History *history, const HistoryEntry *entry)
+{
+    size_t bytes = sizeof(*entry) + entry->delta_size;
+    if(entry->keyframe != NULL)
+        bytes += (history->cells + 7) / 8;
+    return bytes;
+}
+
+static void history_drop(History *history, int from, int to)
+{
+    for(int i = from ; i < to ; i++)
+    {
+        history->bytes -= history_entry_bytes(history, &history->entries[i]);
+        free(history->entries[i].delta);
+        free(history->entries[i].keyframe);
+    }
+    memmove(&history->entries[from], &history->entries[to], (history->count - to) * sizeof(HistoryEntry));
+    history->count -= to - from;
+}
+
+static unsigned char *history_pack(const History *history, const bool *board)
+{
+    unsigned char *packed = calloc(1, (history->cells + 7) / 8);
+    for(size_t i = 0 ; i < history->cells ; i++)
+        if(board[i])
+            packed[i >> 3] |= 1 << (i & 7);
+    return packed;
+}
+
+static void history_push(History *history, HistoryEntry entry)
+{
+    if(history->count == history->capacity)
+    {
+        history->capacity = history->capacity ? history->capacity * 2 : 256;
+        history->entries = realloc(history->entries, history->capacity * sizeof(HistoryEntry));
+    }
+    
+    history->entries[history->count++] = entry;
+    history->cursor = history->count - 1;
+    history->bytes += history_entry_bytes(history, &entry);
+    
+    if(entry.keyframe != NULL)
+        history->since_keyframe = 0;
+    else
+        history->since_keyframe++;
+}
+
+// appends the transition before -> after. `before` must be the board the cursor points at,
+// unless it was edited since, in which case it is stored as a keyframe first.
+static void history_record(History *history, const bool *before, long before_generation, const bool *after, long after_generation)
+{
+    if(history->cursor < history->count - 1)
+        history_drop(history, history->cursor + 1, history->count);
+    
+    if(history->count == 0 || history->edited)
+    {
+        HistoryEntry base = { 0 };
+        base.generation = before_generation;
+        base.keyframe = history_pack(history, before);
+        history_push(history, base);
+        history->edited = false;
+    }
+    
+    // varint gaps between flipped cells, compared a word at a time to skip unchanged runs
+    size_t capacity = 4096;
+    size_t size = 0;
+    unsigned char *delta = malloc(capacity);
+    size_t prev = (size_t)-1;
+    
+    size_t words = history->cells / sizeof(uint64_t);
+    for(size_t i = 0 ; i < history->cells ; i++)
+    {
+        if((i % sizeof(uint64_t)) == 0 && i / sizeof(uint64_t) < words)
+        {
+            uint64_t a, b;
+            memcpy(&a, before + i, sizeof(a));
+            memcpy(&b, after + i, sizeof(b));
+            if(a == b)
+            {
+                i += sizeof(uint64_t) - 1;
+                continue;
+            }
+        }
+        
+        if(before[i] == after[i])
+            continue;
+        
+        if(size + 10 > capacity)
+        {
+            capacity *= 2;
+            delta = realloc(delta, capacity);
+        }
+        
+        size_t gap = i - prev;
+        while(gap >= 0x80)
+        {
+            delta[size++] = (gap & 0x7f) | 0x80;
+            gap >>= 7;
+        }
+        delta[size++] = gap;
+        prev = i;
+    }
+    
+    HistoryEntry entry = { 0 };
+    entry.generation = after_generation;
+    entry.has_delta = true;
+    entry.delta = realloc(delta, size ? size : 1);
+    entry.delta_size = size;
+    if(history->since_keyframe + 1 >= history->keyframe_interval)
+        entry.keyframe = history_pack(history, after);
+    history_push(history, entry);
+    
+    // over budget: forget the oldest keyframe and the deltas up to the next one,
+    // so the oldest retained entry can always be rebuilt
+    while(history->bytes > history->budget)
+    {
+        int next_keyframe = 1;
+        while(next_keyframe < history->count && history->entries[next_keyframe].keyframe == NULL)
+            next_keyframe++;
+        if(next_keyframe >= history->cursor)
+            break;
+        history_drop(history, 0, next_keyframe);
+        history->cursor = history->count - 1;
+    }
+}
+
+// the board no longer matches the cursor entry: the future is discarded,
+// and the next recorded transition starts from a fresh keyframe
+static void history_mark_edited(History *history)
+{
+    if(history->cursor < history->count - 1)
+        history_drop(history, history->cursor + 1, history->count);
+    history->edited = true;
+}
+
+static void history_apply_delta(const HistoryEntry *entry, bool *board)
+{
+    size_t index = (size_t)-1;
+    size_t i = 0;
+    while(i < entry->delta_size)
+    {
+        size_t gap = 0;
+        int shift = 0;
+        while(entry->delta[i] & 0x80)
+        {
+            gap |= (size_t)(entry->delta[i++] & 0x7f) << shift;
+            shift += 7;
+        }
+        gap |= (size_t)entry->delta[i++] << shift;
+        
+        index += gap;
+        board[index] ^= 1;
+    }
+}
+
+static void history_load_keyframe(const History *history, const HistoryEntry *entry, bool *board)
+{
+    for(size_t i = 0 ; i < history->cells ; i++)
+        board[i] = (entry->keyframe[i >> 3] >> (i & 7)) & 1;
+}
+
+// moves `board` to the state of entry `target`. neighbouring entries are reached
+// by XOR-ing deltas (each delta undoes itself), far ones from the closest keyframe.
+static void history_seek(History *history, bool *board, int target)
+{
+    // unrecorded edits mean the board no longer matches the cursor entry,
+    // so it has to be rebuilt from a keyframe
+    bool matches_cursor = !history->edited;
+    history->edited = false;
+    
+    int keyframe = target;
+    while(history->entries[keyframe].keyframe == NULL)
+        keyframe--;
+    
+    bool walk_back = matches_cursor && target < history->cursor && history->cursor - target <= target - keyframe;
+    for(int i = target + 1 ; walk_back && i <= history->cursor ; i++)
+        if(!history->entries[i].has_delta)
+            walk_back = false;
+    
+    if(walk_back)
+    {
+        for(int i = history->cursor ; i > target ; i--)
+            history_apply_delta(&history->entries[i], board);
+    }
+    else
+    {
+        int from = history->cursor;
+        if(!matches_cursor || target < history->cursor || keyframe > history->cursor)
+        {
+            history_load_keyframe(history, &history->entries[keyframe], board);
+            from = keyframe;
+        }
+        
+        for(int i = from + 1 ; i <= target ; i++)
+        {
+            if(history->entries[i].has_delta)
+                history_apply_delta(&history->entries[i], board);
+            else
+                history_load_keyframe(history, &history->entries[i], board);
+        }
+    }
+    
+    history->cursor = target;
+}
+
+// allocates a zeroed board buffer, preferring huge pages so large boards
+// don't pay a TLB miss every few rows. tries explicit MAP_HUGETLB pages first,
+// then a 2 MiB aligned mapping with transparent huge pages requested,
+// and logs which one was obtained. NULL if there's no memory at all.
+// madvise() succeeding only means they were requested, so the THP buffer is faulted
+// in up front and the huge pages the kernel actually gave it are read back.
+static void *grid_alloc(size_t size, const char *name)
+{
+#if defined(__linux__)
+    size_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1);
+    
+    if(size >= HUGE_PAGE_SIZE)
+    {
+        void *buffer = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(buffer != MAP_FAILED)
+        {
+            gol_log(GOL_LOG_INFO, "GRID: %s: %zu bytes backed by explicit huge pages (MAP_HUGETLB)", name, size);
+            return buffer;
+        }
+    }
+    
+    // over-map by one huge page so the buffer can start on a huge page boundary
+    size_t mapped = rounded + HUGE_PAGE_SIZE;
+    char *raw = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(raw != MAP_FAILED)
+    {
+        char *buffer = (char*)(((size_t)raw + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1));
+        size_t head = buffer - raw;
+        size_t tail = mapped - head - rounded;
+        if(head > 0)
+            munmap(raw, head);
+        if(tail > 0)
+            munmap(buffer + rounded, tail);
+        
+        if(size < HUGE_PAGE_SIZE || madvise(buffer, rounded, MADV_HUGEPAGE) != 0)
+        {
+            gol_log(GOL_LOG_INFO, "GRID: %s: %zu bytes backed by regular pages", name, size);
+            return buffer;
+        }
+        
+        char mode[16];
+        thp_mode(mode, sizeof(mode));
+        for(size_t i = 0 ; i < rounded ; i += HUGE_PAGE_SIZE)
+            ((volatile char*)buffer)[i] = 0;
+        size_t huge = thp_bytes(buffer);
+        if(huge >= rounded)
+            gol_log(GOL_LOG_INFO, "GRID: %s: %zu bytes backed by transparent huge pages (madvise, THP %s)", name, size, mode);
+        else
+            gol_log(GOL_LOG_INFO, "GRID: %s: %zu bytes, transparent huge pages requested (THP %s) but %zu of %zu bytes obtained", name, size, mode, huge, rounded);
+        
+        return buffer;
+    }
+    
+    gol_log(GOL_LOG_ERROR, "GRID: %s: failed to allocate %zu bytes", name, size);
+    return NULL;
+#else
+    void *buffer = calloc(1, size);
+    if(buffer == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "GRID: %s: failed to allocate %zu bytes", name, size);
+        return NULL;
+    }
+    
+    gol_log(GOL_LOG_INFO, "GRID: %s: %zu bytes backed by regular pages", name, size);
+    return buffer;
+#endif
+}
+
+#if defined(__linux__)
+// the selected THP mode, "always", "madvise" or "never", or "unknown"
+static void thp_mode(char *mode, size_t size)
+{
+    snprintf(mode, size, "unknown");
+    FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if(file == NULL)
+        return;
+    char line[128];
+    if(fgets(line, sizeof(line), file) != NULL)
+    {
+        char *open = strchr(line, '[');
+        char *close = open != NULL ? strchr(open, ']') : NULL;
+        if(close != NULL)
+            snprintf(mode, size, "%.*s", (int)(close - open - 1), open + 1);
+    }
+    fclose(file);
+}
+
+// bytes of the mapping holding buffer that sit on transparent huge pages (AnonHugePages)
+static size_t thp_bytes(const void *buffer)
+{
+    FILE *file = fopen("/proc/self/smaps", "r");
+    if(file == NULL)
+        return 0;
+    
+    char line[256];
+    bool inside = false;
+    size_t kb = 0;
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long start;
+        unsigned long end;
+        // mapping headers start with their address range, the fields below them with a name
+        if(sscanf(line, "%lx-%lx ", &start, &end) == 2)
+            inside = (unsigned long)buffer >= start && (unsigned long)buffer < end;
+        else if(inside && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+            break;
+    }
+    fclose(file);
+    return inside ? kb * 1024 : 0;
+}
+#endif
+
+static void grid_free(void *buffer, size_t size)
+{
+    if(buffer == NULL)
+        return;
+#if defined(__linux__)
+    size_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1);
+    munmap(buffer, rounded);
+#else
+    (void)size;
+    free(buffer);
+#endif
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int gol_wrap(int v, int n)
+{
+    v %= n;
+    return v < 0 ? v + n : v;
+}
+
+GolPattern gol_pattern_alloc(int w, int h)
+{
+    GolPattern pattern = { 0 };
+    if(w < 1 || h < 1 || w > GOL_PATTERN_MAX_SIDE || h > GOL_PATTERN_MAX_SIDE)
+        return pattern;
+    
+    int stride = (w + 63) / 64;
+    pattern.bits = calloc((size_t)stride * h + 1, sizeof(uint64_t));
+    if(pattern.bits == NULL)
+    {
+        gol_log(GOL_LOG_ERROR, "PATTERN: out of memory for a %dx%d pattern", w, h);
+        return pattern;
+    }
+    pattern.w = w;
+    pattern.h = h;
+    pattern.stride = stride;
+    return pattern;
+}
+
+void gol_pattern_free(GolPattern *pattern)
+{
+    free(pattern->bits);
+    memset(pattern, 0, sizeof(*pattern));
+}
+
+GolPattern gol_pattern_clone(const GolPattern *pattern)
+{
+    GolPattern copy = gol_pattern_alloc(pattern->w, pattern->h);
+    if(copy.bits == NULL)
+        return copy;
+    memcpy(copy.bits, pattern->bits, (size_t)pattern->stride * pattern->h * sizeof(uint64_t));
+    return copy;
+}
+
+GolPattern gol_pattern_from_cells(int w, int h, const bool *cells)
+{
+    GolPattern pattern = gol_pattern_alloc(w, h);
+    for(int i = 0 ; i < pattern.h ; i++)
+        for(int j = 0 ; j < pattern.w ; j++)
+            gol_pattern_set(&pattern, j, i, cells[i * w + j]);
+    return pattern;
+}
+
+GolPattern gol_pattern_from_board(const GolBoard *board, int x, int y, int w, int h)
+{
+    cells_sync(board);
+    GolPattern pattern = gol_pattern_alloc(w, h);
+    for(int i = 0 ; i < pattern.h ; i++)
+    {
+        const bool *row = board->cells + gol_wrap(y + i, board->h) * board->w;
+        for(int j = 0 ; j < pattern.w ; j++)
+            gol_pattern_set(&pattern, j, i, row[gol_wrap(x + j, board->w)]);
+    }
+    return pattern;
+}
+
+bool gol_pattern_get(const GolPattern *pattern, int x, int y)
+{
+    return (pattern->bits[y * pattern->stride + x / 64] >> (x % 64)) & 1;
+}
+
+void gol_pattern_set(GolPattern *pattern, int x, int y, bool value)
+{
+    uint64_t *word = &pattern->bits[y * pattern->stride + x / 64];
+    uint64_t mask = (uint64_t)1 << (x % 64);
+    *word = value ? *word | mask : *word & ~mask;
+}
+
+static uint64_t expand_table[256];
+static pthread_once_t expand_once = PTHREAD_ONCE_INIT;
+
+static void expand_table_init(void)
+{
+    for(int b = 0 ; b < 256 ; b++)
+    {
+        unsigned char bytes[8];
+        for(int i = 0 ; i < 8 ; i++)
+            bytes[i] = (b >> i) & 1;
+        memcpy(&expand_table[b], bytes, 8);
+    }
+}
+
+// 8 pattern bits -> 8 board bytes of 0 or 1
+static uint64_t expand_byte(unsigned bits)
+{
+    pthread_once(&expand_once, expand_table_init);
+    return expand_table[bits & 0xff];
+}
+
+// writes row `row` of the pattern to board row `y` starting at column `x`,
+// 8 cells per store, splitting the row where it wraps around the right edge
+// the caller reports the change with gol_cells_changed()
+void gol_pattern_blit_row(const GolPattern *pattern, int row, GolBoard *board, int x, int y)
+{
+    cells_sync(board);
+    const uint64_t *bits = pattern->bits + row * pattern->stride;
+    bool *dst_row = board->cells + y * board->w;
+    
+    int col = 0;
+    while(col < pattern->w)
+    {
+        int dst_x = gol_wrap(x + col, board->w);
+        int run = board->w - dst_x;
+        if(run > pattern->w - col)
+            run = pattern->w - col;
+        
+        for(int j = 0 ; j < run ; j += 8)
+        {
+            int c = col + j;
+            uint64_t word = bits[c / 64] >> (c % 64);
+            if(c % 64 > 56)
+                word |= bits[c / 64 + 1] << (64 - c % 64);
+            
+            uint64_t cells = expand_byte(word);
+            memcpy(dst_row + dst_x + j, &cells, run - j < 8 ? run - j : 8);
+        }
+        
+        col += run;
+    }
+}
+
+// RLE as used by other Life programs: a "x = W, y = H" header, then runs of
+// 'b' (dead) and 'o' (alive), '$' ending a row and '!' ending the pattern
+char *gol_pattern_to_rle(const GolPattern *pattern, const char *rule)
+{
+    size_t capacity = 256;
+    size_t size = 0;
+    char *text = malloc(capacity);
+    size += snprintf(text, capacity, "x = %d, y = %d, rule = %s\n", pattern->w, pattern->h, rule);
+    
+    int line = 0;
+    int pending_rows = 0;
+    for(int i = 0 ; i < pattern->h ; i++)
+    {
+        int j = 0;
+        while(j < pattern->w)
+        {
+            bool alive = gol_pattern_get(pattern, j, i);
+            int run = 1;
+            while(j + run < pattern->w && gol_pattern_get(pattern, j + run, i) == alive)
+                run++;
+            j += run;
+            
+            // dead cells at the end of a row are implied
+            if(!alive && j == pattern->w)
+                break;
+            
+            char token[48];
+            int len = 0;
+            if(pending_rows > 0)
+                len += snprintf(token + len, sizeof(token) - len, pending_rows > 1 ? "%d$" : "$", pending_rows);
+            pending_rows = 0;
+            if(run > 1)
+                len += snprintf(token + len, sizeof(token) - len, "%d", run);
+            token[len++] = alive ? 'o' : 'b';
+            
+            if(size + len + 4 > capacity)
+            {
+                capacity *= 2;
+                text = realloc(text, capacity);
+            }
+            if(line + len > 70)
+            {
+                text[size++] = '\n';
+                line = 0;
+            }
+            memcpy(text + size, token, len);
+            size += len;
+            line += len;
+        }
+        pending_rows++;
+    }
+    
+    if(size + 3 > capacity)
+        text = realloc(text, capacity + 3);
+    text[size++] = '!';
+    text[size++] = '\n';
+    text[size] = '\0';
+    return text;
+}
+
+bool gol_pattern_from_rle(const char *text, GolPattern *out)
+{
+    // skip comment lines, then read the header
+    while(*text == '#')
+    {
+        while(*text && *text != '\n')
+            text++;
+        if(*text)
+            text++;
+    }
+    
+    int w = 0;
+    int h = 0;
+    if(sscanf(text, " x = %d , y = %d", &w, &h) != 2 || w <= 0 || h <= 0 || w > GOL_PATTERN_MAX_SIDE || h > GOL_PATTERN_MAX_SIDE)
+        return false;
+    while(*text && *text != '\n')
+        text++;
+    
+    GolPattern pattern = gol_pattern_alloc(w, h);
+    if(pattern.bits == NULL)
+        return false;
+    int x = 0;
+    int y = 0;
+    int count = 0;
+    for( ; *text && *text != '!' ; text++)
+    {
+        char c = *text;
+        if(c >= '0' && c <= '9')
+        {
+            // runs past the pattern end up clamped below, keep the count from overflowing
+            if(count <= GOL_PATTERN_MAX_SIDE)
+                count = count * 10 + (c - '0');
+            continue;
+        }
+        if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            continue;
+        
+        int run = count ? count : 1;
+        count = 0;
+        
+        if(c == '$')
+        {
+            y = y + run < h ? y + run : h;
+            x = 0;
+        }
+        else if(c == 'b' || c == '.')
+        {
+            x = x + run < w ? x + run : w;
+        }
+        else if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+        {
+            // 'o' and any multi-state letter count as alive
+            for(int i = 0 ; i < run && x < w ; i++, x++)
+                if(y < h)
+                    gol_pattern_set(&pattern, x, y, true);
+        }
+        else
+        {
+            gol_pattern_free(&pattern);
+            return false;
+        }
+    }
+    
+    *out = pattern;
+    return true;
+}
+
+// rotates by `rotation` quarter turns clockwise, after mirroring left to right if `flip`
+GolPattern gol_pattern_transform(const GolPattern *pattern, int rotation, bool flip)
+{
+    int w = pattern->w;
+    int h = pattern->h;
+    GolPattern out = rotation % 2 ? gol_pattern_alloc(h, w) : gol_pattern_alloc(w, h);
+    if(out.bits == NULL)
+        return out;
+    
+    for(int y = 0 ; y < h ; y++)
+    {
+        for(int x = 0 ; x < w ; x++)
+        {
+            if(!gol_pattern_get(pattern, x, y))
+                continue;
+            
+            int fx = flip ? w - 1 - x : x;
+            switch(rotation % 4)
+            {
+                case 0: gol_pattern_set(&out, fx, y, true); break;
+                case 1: gol_pattern_set(&out, h - 1 - y, fx, true); break;
+                case 2: gol_pattern_set(&out, w - 1 - fx, h - 1 - y, true); break;
+                case 3: gol_pattern_set(&out, y, w - 1 - fx, true); break;
+            }
+        }
+    }
+    
+    return out;
+}
+
+uint64_t gol_hash(const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    uint64_t hash = 0xcbf29ce484222325;
+    for(size_t i = 0 ; i < size ; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
@@ -0,0 +1,153 @@
+// libgol: the simulation core of the Game of Life viewer, without any rendering.
+// a board is a torus of w x h cells, one byte each, stepped under a rule string such as
+// "B3/S23", "B2/S/C3" or "R5,C0,M1,S34..58,B34..45,NM" (see the README).
+// different boards can be used from different threads, a single board can't.
+// link with -lm -lpthread.
+#ifndef GOL_H
+#define GOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// changed cells are reported in square tiles of this many cells (see gol_dirty_tiles)
+#define GOL_TILE_SIZE 64
+// generations the tiled engine runs per tile pass unless gol_set_temporal_steps() says otherwise
+#define GOL_TEMPORAL_STEPS 4
+// gol_set_threads() takes at most this many
+#define GOL_MAX_THREADS 64
+// longest side of a GolPattern, gol_pattern_alloc() returns an empty pattern past it
+#define GOL_PATTERN_MAX_SIDE (1 << 17)
+
+typedef struct GolBoard GolBoard;
+
+// a rectangle of cells packed 64 to a word, each row starting on a word boundary.
+// used for the clipboard and for stamping patterns onto the board.
+// bits is NULL (and w, h are 0) when a side was out of range or the memory ran out.
+typedef struct {
+    int w;
+    int h;
+    int stride;
+    uint64_t *bits;
+} GolPattern;
+
+// step_ms is the time per generation of the last gol_step() call
+typedef struct {
+    long generation;
+    long population;
+    double step_ms;
+} GolStats;
+
+// growth of the continuous Lenia engine: cells grow by dt at a potential of mu,
+// falling off over sigma, the potential summing a ring of `radius` cells (at least 2)
+typedef struct {
+    float mu;
+    float sigma;
+    float dt;
+    int radius;
+} GolLenia;
+
+enum
+{
+    GOL_ENGINE_AUTO,
+    GOL_ENGINE_REFERENCE,
+    GOL_ENGINE_TILED,
+    GOL_ENGINE_PACKED,
+    GOL_ENGINE_LENIA
+};
+
+enum
+{
+    GOL_LOG_INFO,
+    GOL_LOG_WARNING,
+    GOL_LOG_ERROR
+};
+
+typedef void (*GolLogFunc)(int level, const char *text);
+
+// without a function warnings and errors go to stderr, the rest is dropped
+void gol_set_log(GolLogFunc log);
+
+// NULL if the rule can't be parsed
+GolBoard *gol_create(int w, int h, const char *rule);
+void gol_destroy(GolBoard *board);
+bool gol_rule_valid(const char *rule);
+bool gol_set_rule(GolBoard *board, const char *rule);
+const char *gol_rule(const GolBoard *board);
+int gol_rule_states(const GolBoard *board);
+// false if the engine can't run the board's rule
+bool gol_set_engine(GolBoard *board, int engine);
+void gol_set_threads(GolBoard *board, int threads);
+void gol_set_temporal_steps(GolBoard *board, int steps);
+int gol_width(const GolBoard *board);
+int gol_height(const GolBoard *board);
+
+// v wrapped into 0 .. n - 1, the coordinates of the torus
+int gol_wrap(int v, int n);
+bool gol_get(const GolBoard *board, int x, int y);
+void gol_set(GolBoard *board, int x, int y, bool alive);
+// 0 dead, 1 alive, 2 and up dying (generations rules only), x and y wrap around
+int gol_state(const GolBoard *board, int x, int y);
+// the cells, row by row. the pointer changes with every step. after writing through it
+// call gol_cells_changed() with the rectangle that was written.
+bool *gol_cells(GolBoard *board);
+void gol_cells_changed(GolBoard *board, int x0, int y0, int x1, int y1);
+// one flag per GOL_TILE_SIZE tile, row-major, set when a tile changed. the caller clears them.
+bool *gol_dirty_tiles(GolBoard *board);
+// keeps gol_cells() at the same address across steps, for callers that hold on to it,
+// at the cost of a copy per gol_step() call when the generations don't swap back.
+// writes to pinned cells are picked up by the next gol_step() without gol_cells_changed()
+void gol_pin_cells(GolBoard *board, bool pinned);
+// the cells packed as in a PBM file: rows of (w + 7) / 8 bytes, most significant bit first
+void gol_pack(const GolBoard *board, unsigned char *out);
+
+// returns how many generations were run, always `generations`
+long gol_step(GolBoard *board, long generations);
+// a byte per cell counting the generations it has been alive in a row, up to 255, 0 for dead
+// cells. off by default; while it's on gol_step runs one generation at a time, and
+// edited cells start over. false if there's no memory for them, ages stay off then.
+bool gol_set_age(GolBoard *board, bool enabled);
+// NULL while ages are off
+const unsigned char *gol_age(const GolBoard *board);
+GolStats gol_stats(const GolBoard *board);
+
+// past generations are kept as compressed deltas within `budget` bytes,
+// with a whole board every `keyframe_interval` entries. gol_step records one entry per
+// chunk of up to GOL_TEMPORAL_STEPS generations (see gol_set_temporal_steps), step one
+// generation per call for an entry per generation.
+void gol_history_enable(GolBoard *board, size_t budget, int keyframe_interval);
+int gol_history_count(const GolBoard *board);
+int gol_history_cursor(const GolBoard *board);
+void gol_history_seek(GolBoard *board, int index);
+
+GolLenia gol_lenia(const GolBoard *board);
+void gol_set_lenia(GolBoard *board, GolLenia lenia);
+const float *gol_lenia_cells(GolBoard *board);
+void gol_lenia_seed(GolBoard *board, int x, int y, int size);
+
+GolPattern gol_pattern_alloc(int w, int h);
+void gol_pattern_free(GolPattern *pattern);
+GolPattern gol_pattern_clone(const GolPattern *pattern);
+GolPattern gol_pattern_from_cells(int w, int h, const bool *cells);
+GolPattern gol_pattern_from_board(const GolBoard *board, int x, int y, int w, int h);
+bool gol_pattern_get(const GolPattern *pattern, int x, int y);
+void gol_pattern_set(GolPattern *pattern, int x, int y, bool value);
+void gol_pattern_blit_row(const GolPattern *pattern, int row, GolBoard *board, int x, int y);
+char *gol_pattern_to_rle(const GolPattern *pattern, const char *rule);
+bool gol_pattern_from_rle(const char *text, GolPattern *out);
+GolPattern gol_pattern_transform(const GolPattern *pattern, int rotation, bool flip);
+uint64_t gol_hash(const void *data, size_t size);
+
+// a board the size of the file, NULL if it can't be read
+GolBoard *gol_load_pbm(const char *path, const char *rule);
+bool gol_save_pbm(const GolBoard *board, const char *path);
+// the whole board as RLE, free() it
+char *gol_export_rle(const GolBoard *board);
+// steps a board file without loading it into memory, in_path may be out_path
+bool gol_stream_pbm(const char *rule, const char *in_path, const char *out_path, long generations);
+
+// print their results to stdout, return 0 when everything matched
+int gol_bench(int w, int h, const char *rule, int generations, int k, int threads);
+int gol_verify(const char *rule, int generations, int threads);
+
+#endif
@@ -0,0 +1,404 @@
+// the `gol` Python module: libgol boards as Python objects.
+// a Board exports its cells through the buffer protocol as a writable h x w uint8 array,
+// so numpy.asarray(board) shares memory with the board instead of copying it.
+// the cells are pinned while exported, the array stays valid across steps.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "gol.h"
+
+typedef struct {
+    PyObject_HEAD
+    GolBoard *board;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+    int exports;
+    // set while a step runs without the GIL, the board can't be touched from Python then
+    bool busy;
+} Board;
+
+static PyTypeObject BoardType;
+
+static const char *engine_names[] = { "auto", "reference", "tiled", "packed", "lenia" };
+
+static bool board_ready(Board *self)
+{
+    if(self->board == NULL)
+    {
+        PyErr_SetString(PyExc_ValueError, "board is not initialized");
+        return false;
+    }
+    if(self->busy)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "board is being stepped by another thread");
+        return false;
+    }
+    return true;
+}
+
+static bool board_setup(Board *self, GolBoard *board, const char *engine, int threads)
+{
+    int index = -1;
+    for(int i = 0 ; i < (int)(sizeof(engine_names) / sizeof(engine_names[0])) ; i++)
+        if(strcmp(engine, engine_names[i]) == 0)
+            index = i;
+    
+    if(index < 0 || !gol_set_engine(board, index))
+    {
+        PyErr_Format(PyExc_ValueError, "engine \"%s\" can't run rule \"%s\"", engine, gol_rule(board));
+        gol_destroy(board);
+        return false;
+    }
+    gol_set_threads(board, threads);
+    
+    gol_destroy(self->board);
+    self->board = board;
+    self->shape[0] = gol_height(board);
+    self->shape[1] = gol_width(board);
+    self->strides[0] = gol_width(board);
+    self->strides[1] = 1;
+    return true;
+}
+
+static int Board_init(Board *self, PyObject *args, PyObject *kwds)
+{
+    static char *keywords[] = { "width", "height", "rule", "engine", "threads", NULL };
+    int w, h;
+    const char *rule = "B3/S23";
+    const char *engine = "auto";
+    int threads = 1;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "ii|ssi", keywords, &w, &h, &rule, &engine, &threads))
+        return -1;
+    
+    if(self->exports > 0)
+    {
+        PyErr_SetString(PyExc_BufferError, "board is exported");
+        return -1;
+    }
+    
+    GolBoard *board = gol_create(w, h, rule);
+    if(board == NULL)
+    {
+        PyErr_Format(PyExc_ValueError, "can't create a %dx%d board with rule \"%s\"", w, h, rule);
+        return -1;
+    }
+    return board_setup(self, board, engine, threads) ? 0 : -1;
+}
+
+static void Board_dealloc(Board *self)
+{
+    gol_destroy(self->board);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int Board_getbuffer(Board *self, Py_buffer *view, int flags)
+{
+    if(self->board == NULL)
+    {
+        PyErr_SetString(PyExc_BufferError, "board is not initialized");
+        return -1;
+    }
+    if(self->busy)
+    {
+        PyErr_SetString(PyExc_BufferError, "board is being stepped by another thread");
+        return -1;
+    }
+    
+    if(self->exports++ == 0)
+        gol_pin_cells(self->board, true);
+    
+    view->obj = (PyObject*)self;
+    Py_INCREF(self);
+    view->buf = gol_cells(self->board);
+    view->len = self->shape[0] * self->shape[1];
+    view->readonly = 0;
+    view->itemsize = 1;
+    view->format = (flags & PyBUF_FORMAT) ? "B" : NULL;
+    view->ndim = 2;
+    view->shape = self->shape;
+    view->strides = self->strides;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+static void Board_releasebuffer(Board *self, Py_buffer *view)
+{
+    (void)view;
+    if(--self->exports == 0)
+        gol_pin_cells(self->board, false);
+}
+
+static PyBufferProcs Board_as_buffer = {
+    (getbufferproc)Board_getbuffer,
+    (releasebufferproc)Board_releasebuffer,
+};
+
+static PyObject *Board_step(Board *self, PyObject *args)
+{
+    long generations = 1;
+    if(!PyArg_ParseTuple(args, "|l", &generations))
+        return NULL;
+    if(!board_ready(self))
+        return NULL;
+    
+    long done;
+    self->busy = true;
+    Py_BEGIN_ALLOW_THREADS
+    done = gol_step(self->board, generations);
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    
+    return PyLong_FromLong(done);
+}
+
+static PyObject *Board_get(Board *self, PyObject *args)
+{
+    int x, y;
+    if(!PyArg_ParseTuple(args, "ii", &x, &y) || !board_ready(self))
+        return NULL;
+    return PyLong_FromLong(gol_state(self->board, x, y));
+}
+
+static PyObject *Board_set(Board *self, PyObject *args)
+{
+    int x, y;
+    int alive;
+    if(!PyArg_ParseTuple(args, "iip", &x, &y, &alive) || !board_ready(self))
+        return NULL;
+    gol_set(self->board, x, y, alive);
+    Py_RETURN_NONE;
+}
+
+static PyObject *Board_stats(Board *self, PyObject *Py_UNUSED(ignored))
+{
+    if(!board_ready(self))
+        return NULL;
+    GolStats stats = gol_stats(self->board);
+    return Py_BuildValue("{s:l,s:l,s:d}", "generation", stats.generation, "population", stats.population, "step_ms", stats.step_ms);
+}
+
+// the cells packed 8 to a byte as an h x ((w + 7) / 8) memoryview over a copy,
+// numpy.unpackbits(numpy.asarray(board.packed()), axis=1)[:, :w] unpacks it
+static PyObject *Board_packed(Board *self, PyObject *Py_UNUSED(ignored))
+{
+    if(!board_ready(self))
+        return NULL;
+    
+    int row_bytes = (gol_width(self->board) + 7) / 8;
+    int h = gol_height(self->board);
+    PyObject *bytes = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)row_bytes * h);
+    if(bytes == NULL)
+        return NULL;
+    gol_pack(self->board, (unsigned char*)PyBytes_AS_STRING(bytes));
+    
+    PyObject *flat = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if(flat == NULL)
+        return NULL;
+    PyObject *view = PyObject_CallMethod(flat, "cast", "s(ii)", "B", h, row_bytes);
+    Py_DECREF(flat);
+    return view;
+}
+
+static PyObject *Board_save_pbm(Board *self, PyObject *args)
+{
+    const char *path;
+    if(!PyArg_ParseTuple(args, "s", &path) || !board_ready(self))
+        return NULL;
+    if(!gol_save_pbm(self->board, path))
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    Py_RETURN_NONE;
+}
+
+static PyObject *Board_to_rle(Board *self, PyObject *Py_UNUSED(ignored))
+{
+    if(!board_ready(self))
+        return NULL;
+    char *text = gol_export_rle(self->board);
+    PyObject *result = PyUnicode_FromString(text);
+    free(text);
+    return result;
+}
+
+static PyObject *Board_get_width(Board *self, void *closure)
+{
+    (void)closure;
+    return PyLong_FromSsize_t(self->shape[1]);
+}
+
+static PyObject *Board_get_height(Board *self, void *closure)
+{
+    (void)closure;
+    return PyLong_FromSsize_t(self->shape[0]);
+}
+
+static PyObject *Board_get_rule(Board *self, void *closure)
+{
+    (void)closure;
+    if(self->board == NULL)
+        Py_RETURN_NONE;
+    return PyUnicode_FromString(gol_rule(self->board));
+}
+
+static PyObject *Board_get_cells(Board *self, void *closure)
+{
+    (void)closure;
+    return PyMemoryView_FromObject((PyObject*)self);
+}
+
+static PyMethodDef Board_methods[] = {
+    { "step", (PyCFunction)Board_step, METH_VARARGS, "step(generations=1): runs the generations without holding the GIL, returns how many ran" },
+    { "get", (PyCFunction)Board_get, METH_VARARGS, "get(x, y): 0 dead, 1 alive, 2 and up dying" },
+    { "set", (PyCFunction)Board_set, METH_VARARGS, "set(x, y, alive)" },
+    { "stats", (PyCFunction)Board_stats, METH_NOARGS, "stats(): generation, population and step_ms" },
+    { "packed", (PyCFunction)Board_packed, METH_NOARGS, "packed(): the cells 8 to a byte, most significant bit first, as a copy" },
+    { "save_pbm", (PyCFunction)Board_save_pbm, METH_VARARGS, "save_pbm(path)" },
+    { "to_rle", (PyCFunction)Board_to_rle, METH_NOARGS, "to_rle(): the whole board as RLE" },
+    { NULL }
+};
+
+static PyGetSetDef Board_getset[] = {
+    { "width", (getter)Board_get_width, NULL, "cells per row", NULL },
+    { "height", (getter)Board_get_height, NULL, "rows", NULL },
+    { "rule", (getter)Board_get_rule, NULL, "the rule string", NULL },
+    { "cells", (getter)Board_get_cells, NULL, "the cells as a writable height x width uint8 memoryview, without copying", NULL },
+    { NULL }
+};
+
+static PyTypeObject BoardType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "gol.Board",
+    .tp_doc = "Board(width, height, rule=\"B3/S23\", engine=\"auto\", threads=1): a torus of cells",
+    .tp_basicsize = sizeof(Board),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Board_init,
+    .tp_dealloc = (destructor)Board_dealloc,
+    .tp_as_buffer = &Board_as_buffer,
+    .tp_methods = Board_methods,
+    .tp_getset = Board_getset,
+};
+
+// a board the size of a PBM file, or an RLE pattern on a board of at least its size
+static PyObject *gol_py_load(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    (void)module;
+    static char *keywords[] = { "path", "rule", "width", "height", "engine", "threads", NULL };
+    const char *path;
+    const char *rule = "B3/S23";
+    int w = 0;
+    int h = 0;
+    const char *engine = "auto";
+    int threads = 1;
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "s|siisi", keywords, &path, &rule, &w, &h, &engine, &threads))
+        return NULL;
+    
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+    
+    // PBM files are mapped by gol_load_pbm, only RLE text is read in here
+    char magic[2];
+    GolBoard *board = NULL;
+    if(fread(magic, 1, 2, file) == 2 && magic[0] == 'P' && magic[1] == '4')
+    {
+        fclose(file);
+        Py_BEGIN_ALLOW_THREADS
+        board = gol_load_pbm(path, rule);
+        Py_END_ALLOW_THREADS
+    }
+    else
+    {
+        long size = -1;
+        if(fseek(file, 0, SEEK_END) == 0)
+            size = ftell(file);
+        if(size < 0 || fseek(file, 0, SEEK_SET) != 0)
+        {
+            PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+            fclose(file);
+            return NULL;
+        }
+        char *text = malloc((size_t)size + 1);
+        if(text == NULL)
+        {
+            fclose(file);
+            return PyErr_NoMemory();
+        }
+        size_t read = fread(text, 1, size, file);
+        text[read] = '\0';
+        fclose(file);
+        
+        GolPattern pattern;
+        bool parsed = gol_pattern_from_rle(text, &pattern);
+        free(text);
+        if(!parsed)
+        {
+            PyErr_Format(PyExc_ValueError, "%s is neither a binary PBM nor an RLE file", path);
+            return NULL;
+        }
+        
+        board = gol_create(w > pattern.w ? w : pattern.w, h > pattern.h ? h : pattern.h, rule);
+        if(board != NULL)
+        {
+            for(int y = 0 ; y < pattern.h ; y++)
+                gol_pattern_blit_row(&pattern, y, board, 0, y);
+            gol_cells_changed(board, 0, 0, pattern.w - 1, pattern.h - 1);
+        }
+        gol_pattern_free(&pattern);
+    }
+    
+    if(board == NULL)
+    {
+        PyErr_Format(PyExc_ValueError, "can't load %s with rule \"%s\"", path, rule);
+        return NULL;
+    }
+    
+    Board *self = (Board*)PyType_GenericNew(&BoardType, NULL, NULL);
+    if(self == NULL)
+    {
+        gol_destroy(board);
+        return NULL;
+    }
+    if(!board_setup(self, board, engine, threads))
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject*)self;
+}
+
+static PyMethodDef gol_methods[] = {
+    { "load", (PyCFunction)(void(*)(void))gol_py_load, METH_VARARGS | METH_KEYWORDS, "load(path, rule=\"B3/S23\", width=0, height=0, engine=\"auto\", threads=1): a Board from a PBM or RLE file" },
+    { NULL }
+};
+
+static struct PyModuleDef gol_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "gol",
+    .m_doc = "Game of Life boards stepped by libgol",
+    .m_size = -1,
+    .m_methods = gol_methods,
+};
+
+PyMODINIT_FUNC PyInit_gol(void)
+{
+    if(PyType_Ready(&BoardType) < 0)
+        return NULL;
+    
+    PyObject *module = PyModule_Create(&gol_module);
+    if(module == NULL)
+        return NULL;
+    
+    Py_INCREF(&BoardType);
+    if(PyModule_AddObject(module, "Board", (PyObject*)&BoardType) < 0)
+    {
+        Py_DECREF(&BoardType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
@@ -1,4 +1,4 @@
-// config
+// config: the defaults, overridden by gol.ini and then by --key=value arguments
 #define GRID_W 100
 #define GRID_H 100
 #define BACKGROUND BLACK
@@ -8,12 +8,37 @@
 #define CELL_COLOR ORANGE
 #define CELL_SHAPE CIRCLE
 #define HOVER_COLOR SKYBLUE
+#define RULE "B3/S23"
+#define HISTORY_BUDGET_MB 64
+#define HISTORY_KEYFRAME_INTERVAL 64
+#define STEP_BUDGET_MS 12
+#define LINE_FADE_PX 6.0
+#define EDIT_BUDGET_CELLS (4 * 1024 * 1024)
+#define PATTERN_DIR "patterns"
+#define PANEL_W 220
+#define THUMB_SIZE 64
+#define LENIA_RADIUS 13
+#define LENIA_MU 0.15
+#define LENIA_SIGMA 0.015
+#define LENIA_DT 0.1
+#define EXPORT_PNG_MAX_CELLS (64 * 1024 * 1024)
+#define GENS_PER_SEC 10
+#define TARGET_FPS 60
+#define QUALITY_DEGRADE_FRAMES 10
+#define QUALITY_RESTORE_FRAMES 120
+#define SHAPE_TEXTURE_SIZE 64
+#define SHAPE_BATCH 1024
 
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <dirent.h>
+#include <pthread.h>
 
 #if defined(__linux__)
 #include "raylib_linux/include/raylib.h"
@@ -25,66 +50,461 @@
 #include "raylib_windows/include/raymath.h"
 #endif
 
-bool grid [GRID_H][GRID_W] = { 0 };
-bool grid2[GRID_H][GRID_W] = { 0 };
+#include "gol.h"
+#include "server.h"
+#include "record.h"
+
+#define CONFIG_FILE "gol.ini"
+
+#define TILES_X ((config.grid_w + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE)
+#define TILES_Y ((config.grid_h + GOL_TILE_SIZE - 1) / GOL_TILE_SIZE)
+
+// the settings read at startup (see config_load)
+typedef struct {
+    int grid_w;
+    int grid_h;
+    float cell_size;
+    int cell_shape;
+    Color background;
+    Color line_color;
+    Color border_color;
+    Color cell_color;
+    Color hover_color;
+    char rule[64];
+    int engine;
+    int threads;
+    int temporal_steps;
+    GolLenia lenia;
+    int boundary;
+    unsigned int seed;
+    char load[512];
+    int threshold;
+    bool msaa;
+    bool autostart;
+    int fps;
+    bool adaptive;
+    char cell_image[512];
+} Config;
+
+Config config;
+
+// config.grid_h rows of config.grid_w cells, stepped by libgol
+GolBoard *game;
+
+// grid lines for the whole board in one quad: each fragment measures its distance
+// to the nearest cell edge in screen pixels, so lines stay one pixel wide at any zoom
+const char *grid_line_fs =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "uniform vec2 gridSize;\n"
+    "uniform vec4 lineColor;\n"
+    "uniform float fade;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 cell = fragTexCoord * gridSize;\n"
+    "    vec2 dist = abs(cell - round(cell)) / fwidth(cell);\n"
+    "    float line = 1.0 - min(min(dist.x, dist.y), 1.0);\n"
+    "    finalColor = vec4(lineColor.rgb, lineColor.a * line * fade);\n"
+    "}\n";
+
+// the board is set up, and with autostart stepped, on a thread while the main thread
+// opens the window, which takes most of the startup
+typedef struct {
+    GolBoard *board;
+    atomic_bool window_ready;
+    long generations;
+} Startup;
+
+// process start, the STARTUP log lines count from here
+double startup_time;
+
+// set when the whole texture has to be uploaded again, otherwise only
+// the tiles libgol flagged are
+bool dirty_full = true;
+
+// in heatmap mode live cells are colored by age (see heat_palette_init) instead of
+// config.cell_color. libgol only keeps ages while it's on.
+bool heatmap = false;
+Color heat_palette[256];
+
+// fixed timestep: real time is accumulated and converted into whole generations,
+// so speeds above the frame rate run several generations per frame
+typedef struct {
+    double gens_per_sec;
+    bool unlimited;
+    double accumulator;
+    double prev_time;
+} Scheduler;
+
+// detail given up, in order, when drawing doesn't fit in the frame
+enum
+{
+    QUALITY_FULL,
+    QUALITY_NO_LINES,
+    QUALITY_SQUARES,
+    QUALITY_HALF_RATE
+};
+
+// the frame budget controller. drawing time and stepping time are smoothed, a level is
+// dropped after QUALITY_DEGRADE_FRAMES frames over budget and taken back after
+// `restore_wait` frames well within it. a level that has to be dropped again right
+// after it came back waits twice as long the next time.
+typedef struct {
+    int level;
+    double draw_ms;
+    double step_ms;
+    int slow_frames;
+    int fast_frames;
+    int level_frames;
+    int restore_wait;
+    bool restored;
+} Quality;
+
+// a pattern of the library in PATTERN_DIR. parsed patterns are kept in
+// PATTERN_DIR/.cache keyed by the file's content hash, files whose modification
+// time didn't change aren't even read again.
+typedef struct {
+    char path[512];
+    long mtime;
+    uint64_t hash;
+    GolPattern pattern;
+    Texture2D thumbnail;
+} CatalogEntry;
+
+typedef struct {
+    CatalogEntry *entries;
+    int count;
+} Catalog;
+
+// edits are queued while handling input and applied to the board between generations,
+// at most EDIT_BUDGET_CELLS per frame. large rectangles and randomizing continue
+// on the next frame from `progress` (rows already done).
+typedef struct {
+    int kind;
+    int x0, y0;
+    int x1, y1;
+    bool value;
+    int radius;
+    int progress;
+    GolPattern pattern;
+} Edit;
 
 typedef struct {
-    bool n1: 1;
-    bool n2: 1;
-    bool n3: 1;
-    bool n4: 1;
-    bool n5: 1;
-    bool n6: 1;
-    bool n7: 1;
-    bool n8: 1;
-} Neighbors;
-
-Neighbors get_neighbors(bool(*grid)[GRID_H][GRID_W], int x, int y);
-bool new_state(bool is_alive, Neighbors nbrs);
+    Edit *edits;
+    int count;
+    int capacity;
+} EditBatch;
+
+bool config_load(Config *config, int *argc, char **argv);
+void config_help(void);
+bool config_read_file(Config *config, const char *path);
+bool config_set(Config *config, const char *key, const char *value);
+bool parse_color(const char *text, Color *out);
+GolBoard *board_load(const char *path);
+GolBoard *board_setup(void);
+void *startup_thread(void *arg);
+void startup_mark(const char *phase);
+double startup_seconds(void);
+void window_size(int *w, int *h);
+bool board_export(GolBoard *board, bool png);
+Color state_color(int state);
+void heat_palette_init(void);
+void age_texture_update(Texture2D texture, GolBoard *board);
+void lenia_texture_update(Texture2D texture, GolBoard *board);
+void board_texture_update(Texture2D texture, GolBoard *board);
+Texture2D shape_texture(Texture2D *textures, int shape);
+void draw_cell_shapes(Texture2D texture, Camera2D camera);
+void edit_push(EditBatch *batch, Edit edit);
+void edit_line(EditBatch *batch, int x0, int y0, int x1, int y1, int radius, bool value);
+void edit_rect(EditBatch *batch, int x0, int y0, int x1, int y1, bool value);
+void edit_stamp(EditBatch *batch, int x, int y, const GolPattern *pattern);
+bool edit_batch_apply(EditBatch *batch, GolBoard *board, long budget);
+void catalog_load(Catalog *catalog, const char *dir);
+void catalog_free(Catalog *catalog);
+bool catalog_read_cache(Catalog *catalog, const char *path);
+void catalog_write_cache(const Catalog *catalog, const char *path);
+Texture2D catalog_thumbnail(CatalogEntry *entry);
+void catalog_draw_panel(Catalog *catalog, int scroll, int selected);
+void scheduler_reset(Scheduler *scheduler, double now);
+bool quality_update(Quality *quality, double step_ms, double draw_ms);
+long scheduler_due(Scheduler *scheduler, double now);
+void scheduler_consume(Scheduler *scheduler, long steps, bool caught_up);
 void iclamp(int *num, int min, int max);
-bool time_elapsed(double seconds);
+void log_forward(int level, const char *text);
+void log_stderr(int level, const char *text, va_list args);
+void randomize(GolBoard *board);
 
 enum
 {
     CIRCLE,
     SQUARE,
-    TRIANGLE
+    TRIANGLE,
+    CUSTOM,
+    SHAPE_COUNT
 } Cell_Shape;
 
-int main()
+enum
+{
+    TORUS
+} Boundary;
+
+enum
+{
+    EDIT_LINE,
+    EDIT_RECT,
+    EDIT_STAMP,
+    EDIT_RANDOMIZE
+} Edit_Kind;
+
+// glider, stamped with G
+const bool glider_cells[3 * 3] = {
+    0, 1, 0,
+    0, 0, 1,
+    1, 1, 1,
+};
+
+int main(int argc, char **argv)
 {
-    srand(time(NULL));
+    startup_time = startup_seconds();
+    gol_set_log(log_forward);
+    for(int i = 1 ; i < argc ; i++)
+    {
+        if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+        {
+            config_help();
+            return 0;
+        }
+    }
+    if(!config_load(&config, &argc, argv))
+        return 1;
+    // `gol record -` writes its frames to stdout
+    if(argc > 2 && strcmp(argv[1], "record") == 0 && strcmp(argv[2], "-") == 0)
+        SetTraceLogCallback(log_stderr);
+    
+    if(argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        // gol bench [generations] [k]
+        int generations = argc > 2 ? atoi(argv[2]) : 100;
+        int k = argc > 3 ? atoi(argv[3]) : config.temporal_steps;
+        return gol_bench(config.grid_w, config.grid_h, config.rule, generations, k, config.threads);
+    }
+    if(argc > 3 && strcmp(argv[1], "stream") == 0)
+    {
+        // gol stream <in.pbm> <out.pbm> [generations]
+        int generations = argc > 4 ? atoi(argv[4]) : 1;
+        return gol_stream_pbm(config.rule, argv[2], argv[3], generations) ? 0 : 1;
+    }
+    if(argc > 1 && strcmp(argv[1], "verify") == 0)
+    {
+        // gol verify [generations]
+        int generations = argc > 2 ? atoi(argv[2]) : 64;
+        return gol_verify(config.rule, generations, config.threads);
+    }
+    
+    srand(config.seed != 0 ? config.seed : time(NULL));
+    
+    // the runs without a window start from a random board unless one is loaded
+    if(argc > 1 && (strcmp(argv[1], "serve") == 0 || (argc > 2 && strcmp(argv[1], "record") == 0)))
+    {
+        game = board_setup();
+        if(game == NULL)
+            return 1;
+        if(config.load[0] == '\0')
+            randomize(game);
+    }
     
-    bool(*current_grid)[GRID_H][GRID_W] = &grid;
-    bool(*other_grid)  [GRID_H][GRID_W] = &grid2;
+    if(argc > 1 && strcmp(argv[1], "serve") == 0)
+    {
+        // gol serve [port] [generations per second], 0 for as fast as it goes
+        int port = argc > 2 ? atoi(argv[2]) : 8765;
+        double gens_per_sec = argc > 3 ? atof(argv[3]) : 30;
+        int result = server_run(game, port, gens_per_sec);
+        gol_destroy(game);
+        return result;
+    }
+    if(argc > 2 && strcmp(argv[1], "record") == 0)
+    {
+        // gol record <out.gif | out.rgb | -> [frames] [generations per frame] [pixels per cell]
+        long frames = argc > 3 ? atol(argv[3]) : 100;
+        long generations = argc > 4 ? atol(argv[4]) : 1;
+        int scale = argc > 5 ? atoi(argv[5]) : 1;
+        const unsigned char colors[2][3] = {
+            { config.background.r, config.background.g, config.background.b },
+            { config.cell_color.r, config.cell_color.g, config.cell_color.b },
+        };
+        int result = record_run(game, argv[2], frames, generations, scale, colors);
+        gol_destroy(game);
+        return result;
+    }
     
-    int window_w = CELL_SIZE * GRID_W;
-    int window_h = CELL_SIZE * GRID_H;
+    Startup startup = { 0 };
+    pthread_t startup_id;
+    pthread_create(&startup_id, NULL, startup_thread, &startup);
+    
+    // a loaded board's size is only known once it's read, the window is resized then
+    int window_w;
+    int window_h;
+    window_size(&window_w, &window_h);
     
     Camera2D camera = { 0 };
     camera.zoom = 1;
     
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE | (config.msaa ? FLAG_MSAA_4X_HINT : 0));
     InitWindow(window_w, window_h, "Game Of Life");
+    SetTargetFPS(config.fps);
+    startup_mark("window open");
+    
+    atomic_store(&startup.window_ready, true);
+    pthread_join(startup_id, NULL);
+    game = startup.board;
+    if(game == NULL)
+    {
+        CloseWindow();
+        return 1;
+    }
+    if(config.load[0] != '\0')
+    {
+        config.grid_w = gol_width(game);
+        config.grid_h = gol_height(game);
+        window_size(&window_w, &window_h);
+        if(window_w != GetScreenWidth() || window_h != GetScreenHeight())
+            SetWindowSize(window_w, window_h);
+    }
+    
+    // one texel per cell, used to draw square cells with a single quad
+    Image board_image = GenImageColor(config.grid_w, config.grid_h, BLANK);
+    Texture2D board_texture = LoadTextureFromImage(board_image);
+    UnloadImage(board_image);
+    
+    // circles, triangles and custom shapes are stamped from these, made when first drawn
+    Texture2D shape_textures[SHAPE_COUNT] = { 0 };
+    
+    RenderTexture2D board_view = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+    Camera2D drawn_camera = camera;
+    bool board_changed = true;
+    
+    // compiled the first time grid lines are visible, not during startup
+    Shader line_shader = { 0 };
+    int line_fade_loc = -1;
+    
+    bool is_running = config.autostart;
+    
+    Scheduler scheduler = { 0 };
+    scheduler.gens_per_sec = GENS_PER_SEC;
+    scheduler_reset(&scheduler, GetTime());
+    bool presented = false;
     
-    bool is_running = false;
-    double tick_diff = 0.1;
+    Quality quality = { 0 };
+    quality.restore_wait = QUALITY_RESTORE_FRAMES;
+    long frame = 0;
+    
+    EditBatch edits = { 0 };
+    int brush_radius = 0;
+    bool paint_value = true;
+    int last_paint_x = 0;
+    int last_paint_y = 0;
+    bool rect_dragging = false;
+    int rect_x = 0;
+    int rect_y = 0;
+    
+    GolPattern glider = gol_pattern_from_cells(3, 3, glider_cells);
+    GolPattern clip = { 0 };
+    
+    // read when the panel is first opened
+    Catalog catalog = { 0 };
+    bool catalog_loaded = false;
+    bool panel_open = false;
+    int panel_scroll = 0;
+    int placing = -1;
+    int place_rotation = 0;
+    bool place_flip = false;
+    GolPattern place_pattern = { 0 };
+    bool selecting = false;
+    bool has_selection = false;
+    int select_x0 = 0;
+    int select_y0 = 0;
+    int select_x1 = 0;
+    int select_y1 = 0;
+    
+    // L switches to the continuous Lenia engine, in which 1 / 2 change the growth
+    // centre, 3 / 4 its width, 5 / 6 the time step and 7 / 8 the kernel radius
+    bool lenia_mode = config.engine == GOL_ENGINE_LENIA;
+    heat_palette_init();
     
     while(!WindowShouldClose())
     {
-        BeginDrawing();
-        BeginMode2D(camera);
-        ClearBackground(BACKGROUND);
-        
         Vector2 mouse = GetMousePosition();
         Vector2 mouse_world = GetScreenToWorld2D(mouse, camera);
         
-        int hovered_cellx = (mouse_world.x) / (CELL_SIZE);
-        int hovered_celly = (mouse_world.y) / (CELL_SIZE);
-        iclamp(&hovered_cellx, 0, GRID_W - 1);
-        iclamp(&hovered_celly, 0, GRID_H - 1);
+        int hovered_cellx = (mouse_world.x) / (config.cell_size);
+        int hovered_celly = (mouse_world.y) / (config.cell_size);
+        iclamp(&hovered_cellx, 0, config.grid_w - 1);
+        iclamp(&hovered_celly, 0, config.grid_h - 1);
+        
+        // pattern library: tab shows the panel, clicking a pattern picks it for placing
+        // (clicking it again drops it), Q / E rotate it and F flips it
+        bool mouse_on_panel = panel_open && mouse.x >= GetScreenWidth() - PANEL_W;
+        bool place_changed = false;
+        if(IsKeyPressed(KEY_TAB))
+        {
+            panel_open = !panel_open;
+            placing = -1;
+            if(!catalog_loaded)
+            {
+                catalog_load(&catalog, PATTERN_DIR);
+                catalog_loaded = true;
+            }
+        }
+        if(mouse_on_panel)
+        {
+            panel_scroll -= GetMouseWheelMove();
+            iclamp(&panel_scroll, 0, catalog.count > 0 ? catalog.count - 1 : 0);
+            
+            if(IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+            {
+                int index = panel_scroll + mouse.y / (THUMB_SIZE + 8);
+                if(index < catalog.count)
+                {
+                    placing = placing == index ? -1 : index;
+                    place_rotation = 0;
+                    place_flip = false;
+                    place_changed = true;
+                }
+            }
+        }
+        if(placing >= 0)
+        {
+            if(IsKeyPressed(KEY_Q))
+                place_rotation = (place_rotation + 3) % 4;
+            if(IsKeyPressed(KEY_E))
+                place_rotation = (place_rotation + 1) % 4;
+            if(IsKeyPressed(KEY_F))
+                place_flip = !place_flip;
+            
+            if(place_changed || IsKeyPressed(KEY_Q) || IsKeyPressed(KEY_E) || IsKeyPressed(KEY_F))
+            {
+                gol_pattern_free(&place_pattern);
+                place_pattern = gol_pattern_transform(&catalog.entries[placing].pattern, place_rotation, place_flip);
+            }
+        }
         
-        if(IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+        // shift + left drag selects a rectangle instead of moving the view
+        if(!mouse_on_panel && IsKeyDown(KEY_LEFT_SHIFT) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            selecting = true;
+            select_x0 = hovered_cellx;
+            select_y0 = hovered_celly;
+        }
+        if(selecting)
+        {
+            select_x1 = hovered_cellx;
+            select_y1 = hovered_celly;
+            has_selection = true;
+            if(IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
+                selecting = false;
+        }
+        else if(!mouse_on_panel && IsMouseButtonDown(MOUSE_LEFT_BUTTON))
         {
             // dragging
             Vector2 delta = GetMouseDelta();
@@ -93,7 +513,7 @@ int main()
             camera.target.y = camera.target.y - (delta.y * 1/camera.zoom);
         }
         
-        float scroll = GetMouseWheelMove();
+        float scroll = mouse_on_panel ? 0 : GetMouseWheelMove();
         if(scroll != 0 || (IsKeyDown(KEY_MINUS) && camera.zoom >= 0.75) || (IsKeyDown(KEY_EQUAL) && camera.zoom <= 17))
         {
             camera.offset = mouse;
@@ -110,210 +530,1704 @@ int main()
             camera.zoom = Clamp(camera.zoom, 0.75, 17);
         }
         
-        if(!is_running && IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+        // editing: right drag paints with the brush (the pressed cell decides whether it
+        // paints live or dead cells), shift + right drag fills a rectangle, ctrl + right drag clears one
+        // while a library pattern is picked, right click places it instead
+        bool rect_modifier = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_LEFT_CONTROL);
+        if(placing >= 0 || mouse_on_panel)
+        {
+            if(placing >= 0 && !mouse_on_panel && IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+                edit_stamp(&edits, hovered_cellx - place_pattern.w / 2, hovered_celly - place_pattern.h / 2, &place_pattern);
+        }
+        else if(IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
+        {
+            if(rect_modifier)
+            {
+                rect_dragging = true;
+                rect_x = hovered_cellx;
+                rect_y = hovered_celly;
+            }
+            else
+            {
+                paint_value = !gol_get(game, hovered_cellx, hovered_celly);
+                last_paint_x = hovered_cellx;
+                last_paint_y = hovered_celly;
+                edit_line(&edits, hovered_cellx, hovered_celly, hovered_cellx, hovered_celly, brush_radius, paint_value);
+            }
+        }
+        else if(IsMouseButtonDown(MOUSE_BUTTON_RIGHT) && !rect_dragging)
+        {
+            // interpolate from the last painted cell so fast drags don't leave gaps
+            if(hovered_cellx != last_paint_x || hovered_celly != last_paint_y)
+            {
+                edit_line(&edits, last_paint_x, last_paint_y, hovered_cellx, hovered_celly, brush_radius, paint_value);
+                last_paint_x = hovered_cellx;
+                last_paint_y = hovered_celly;
+            }
+        }
+        if(rect_dragging && IsMouseButtonReleased(MOUSE_BUTTON_RIGHT))
+        {
+            edit_rect(&edits, rect_x, rect_y, hovered_cellx, hovered_celly, !IsKeyDown(KEY_LEFT_CONTROL));
+            rect_dragging = false;
+        }
+        if(IsKeyPressed(KEY_LEFT_BRACKET) && brush_radius > 0)
+        {
+            brush_radius--;
+        }
+        if(IsKeyPressed(KEY_RIGHT_BRACKET) && brush_radius < 32)
+        {
+            brush_radius++;
+        }
+        if(IsKeyPressed(KEY_G))
+        {
+            edit_stamp(&edits, hovered_cellx - 1, hovered_celly - 1, &glider);
+        }
+        
+        // ctrl + C / X copy / cut the selection, also putting it on the system clipboard as RLE.
+        // ctrl + V pastes the clipboard if it holds RLE, the last copied cells otherwise.
+        bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+        if(ctrl && has_selection && (IsKeyPressed(KEY_C) || IsKeyPressed(KEY_X)))
+        {
+            int x0 = select_x0 < select_x1 ? select_x0 : select_x1;
+            int y0 = select_y0 < select_y1 ? select_y0 : select_y1;
+            int w = abs(select_x1 - select_x0) + 1;
+            int h = abs(select_y1 - select_y0) + 1;
+            
+            gol_pattern_free(&clip);
+            clip = gol_pattern_from_board(game, x0, y0, w, h);
+            
+            char *rle = gol_pattern_to_rle(&clip, gol_rule(game));
+            SetClipboardText(rle);
+            free(rle);
+            
+            if(IsKeyPressed(KEY_X))
+                edit_rect(&edits, select_x0, select_y0, select_x1, select_y1, false);
+        }
+        if(ctrl && IsKeyPressed(KEY_V))
         {
-            (*current_grid)[hovered_celly][hovered_cellx] ^= 1;
+            const char *text = GetClipboardText();
+            GolPattern pasted;
+            if(text != NULL && gol_pattern_from_rle(text, &pasted))
+            {
+                gol_pattern_free(&clip);
+                clip = pasted;
+            }
+            if(clip.bits != NULL)
+                edit_stamp(&edits, hovered_cellx, hovered_celly, &clip);
         }
         
-        if(IsKeyPressed(KEY_C) && !is_running)
+        if(IsKeyPressed(KEY_C) && !ctrl)
         {
-            memset(current_grid, 0, sizeof(grid));
+            edit_rect(&edits, 0, 0, config.grid_w - 1, config.grid_h - 1, false);
         }
-        if(IsKeyPressed(KEY_R) && !is_running)
+        if(IsKeyPressed(KEY_R) && lenia_mode)
         {
-            memset(current_grid, 0, sizeof(grid));
-            for(int i = 0 ; i < GRID_H ; i++)
-                for(int j = 0 ; j < GRID_W ; j++)
-                    (*current_grid)[i][j] = rand() % 2;
+            // binary noise dies out under most growth functions, seed a patch of values instead
+            gol_lenia_seed(game, hovered_cellx, hovered_celly, 4 * gol_lenia(game).radius);
+            board_changed = true;
+        }
+        else if(IsKeyPressed(KEY_R))
+        {
+            edit_push(&edits, (Edit){ .kind = EDIT_RANDOMIZE, .x1 = config.grid_w - 1, .y1 = config.grid_h - 1 });
         }
         if(IsKeyPressed(KEY_S) || IsKeyPressed(KEY_SPACE))
         {
             is_running = !is_running;
+            scheduler_reset(&scheduler, GetTime());
         }
-        if(IsKeyPressed(KEY_UP) && tick_diff >= 0.0001)
+        if(IsKeyPressed(KEY_UP) && scheduler.gens_per_sec <= 100000)
         {
-            tick_diff -= 0.01;
+            scheduler.gens_per_sec *= 1.25;
         }
-        if(IsKeyPressed(KEY_DOWN) && tick_diff <= 4)
+        if(IsKeyPressed(KEY_DOWN) && scheduler.gens_per_sec >= 0.25)
         {
-            tick_diff += 0.01;
+            scheduler.gens_per_sec /= 1.25;
+        }
+        if(IsKeyPressed(KEY_U))
+        {
+            scheduler.unlimited = !scheduler.unlimited;
+        }
+        if(IsKeyPressed(KEY_T))
+        {
+            // custom is only in the cycle when there's an image for it
+            config.cell_shape = (config.cell_shape + 1) % (config.cell_image[0] != '\0' ? SHAPE_COUNT : CUSTOM);
+            board_changed = true;
+        }
+        if(IsKeyPressed(KEY_P))
+        {
+            board_export(game, !IsKeyDown(KEY_LEFT_SHIFT));
+        }
+        if(IsKeyPressed(KEY_H))
+        {
+            heatmap = !heatmap;
+            if(!gol_set_age(game, heatmap))
+                heatmap = false;
+            dirty_full = true;
+            board_changed = true;
+        }
+        if(IsKeyPressed(KEY_L))
+        {
+            if(gol_set_engine(game, !lenia_mode ? GOL_ENGINE_LENIA : config.engine == GOL_ENGINE_LENIA ? GOL_ENGINE_AUTO : config.engine))
+                lenia_mode = !lenia_mode;
+            dirty_full = true;
+            board_changed = true;
+        }
+        if(lenia_mode)
+        {
+            GolLenia lenia = gol_lenia(game);
+            if(IsKeyPressed(KEY_ONE))
+                lenia.mu -= 0.005;
+            if(IsKeyPressed(KEY_TWO))
+                lenia.mu += 0.005;
+            if(IsKeyPressed(KEY_THREE) && lenia.sigma > 0.002)
+                lenia.sigma -= 0.001;
+            if(IsKeyPressed(KEY_FOUR))
+                lenia.sigma += 0.001;
+            if(IsKeyPressed(KEY_FIVE) && lenia.dt > 0.015)
+                lenia.dt -= 0.01;
+            if(IsKeyPressed(KEY_SIX) && lenia.dt < 1)
+                lenia.dt += 0.01;
+            if((IsKeyPressed(KEY_SEVEN) && lenia.radius > 2) || IsKeyPressed(KEY_EIGHT))
+                lenia.radius += IsKeyPressed(KEY_EIGHT) ? 1 : -1;
+            gol_set_lenia(game, lenia);
         }
         
-        // Color the hovered cell
-        DrawRectangle(hovered_cellx * CELL_SIZE, hovered_celly * CELL_SIZE, CELL_SIZE, CELL_SIZE, HOVER_COLOR);
-        
-        for(int i = 0 ; i < GRID_H ; i++)
+        // scrubbing through the history while stopped, shift moves 10 generations at a time
+        int scrub = 0;
+        if(IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT))
+            scrub = -1;
+        if(IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT))
+            scrub = 1;
+        if(IsKeyDown(KEY_LEFT_SHIFT))
+            scrub *= 10;
+        if(!is_running && scrub != 0 && gol_history_count(game) > 0)
         {
-            for(int j = 0 ; j < GRID_W ; j++)
+            int target = gol_history_cursor(game) + scrub;
+            iclamp(&target, 0, gol_history_count(game) - 1);
+            if(target != gol_history_cursor(game))
             {
-                if((*current_grid)[i][j])
-                {
-                    switch(CELL_SHAPE)
-                    {
-                        case CIRCLE:
-                            DrawCircle(j * CELL_SIZE + CELL_SIZE/2, i * CELL_SIZE + CELL_SIZE/2, CELL_SIZE / 2, CELL_COLOR);
-                            break;
-                        case SQUARE:
-                            DrawRectangle(j * CELL_SIZE, i * CELL_SIZE, CELL_SIZE, CELL_SIZE, CELL_COLOR);
-                            break;
-                        case TRIANGLE:
-                            DrawTriangle(
-                                (Vector2){j * CELL_SIZE + CELL_SIZE/2, i * CELL_SIZE},
-                                (Vector2){j * CELL_SIZE, i * CELL_SIZE + CELL_SIZE},
-                                (Vector2){j * CELL_SIZE + CELL_SIZE, i * CELL_SIZE + CELL_SIZE},
-                                CELL_COLOR
-                            );
-                            break;
-                    }
-                }
+                gol_history_seek(game, target);
+                dirty_full = true;
+                board_changed = true;
             }
         }
         
-        // left border
-        DrawLine(
-                0, 0,
-                (CELL_SIZE * GRID_W), 0,
-                BORDER_COLOR
-        );
-        // right border
-        DrawLine(
-            0, (GRID_H * CELL_SIZE),
-            (CELL_SIZE * GRID_W), (GRID_H * CELL_SIZE),
-            BORDER_COLOR
-        );
-        // top border
-        DrawLine(
-            0, 0,
-            0, (CELL_SIZE * GRID_H),
-            BORDER_COLOR
-        );
-        // bottom border
-        DrawLine(
-            (GRID_W * CELL_SIZE), 0,
-            (GRID_W * CELL_SIZE), (CELL_SIZE * GRID_H),
-            BORDER_COLOR
-        );
+        // pending edits land between generations, never in the middle of a step
+        if(edits.count > 0 && edit_batch_apply(&edits, game, EDIT_BUDGET_CELLS))
+        {
+            board_changed = true;
+        }
         
-        for(int i = 1 ; i < GRID_H ; i++)
+        double step_start = GetTime();
+        if(is_running)
         {
-            DrawLine(
-                0, (i * CELL_SIZE),
-                (CELL_SIZE * GRID_W), (i * CELL_SIZE),
-                LINE_COLOR
-            );
+            // run as many due generations as fit in the step budget,
+            // temporal_steps at a time when there are enough of them
+            double now = GetTime();
+            double deadline = now + STEP_BUDGET_MS / 1000.0;
+            long due = scheduler_due(&scheduler, now);
+            long done = 0;
+            
+            while(done < due && (done == 0 || GetTime() < deadline))
+            {
+                int k = due - done < config.temporal_steps ? due - done : config.temporal_steps;
+                done += gol_step(game, k);
+            }
+            
+            scheduler_consume(&scheduler, done, done >= due);
+            if(done > 0)
+                board_changed = true;
         }
+        double draw_start = GetTime();
         
-        for(int i = 1 ; i < GRID_W ; i++)
+        // the board is only redrawn into board_view when it or the view changed,
+        // otherwise the previous picture is reused
+        bool view_changed = false;
+        if(GetScreenWidth() != board_view.texture.width || GetScreenHeight() != board_view.texture.height)
         {
-            DrawLine(
-                (i * CELL_SIZE), 0,
-                (i * CELL_SIZE), (CELL_SIZE * GRID_H),
-                LINE_COLOR
-            );
+            UnloadRenderTexture(board_view);
+            board_view = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+            view_changed = true;
+        }
+        if(memcmp(&camera, &drawn_camera, sizeof(camera)) != 0)
+        {
+            view_changed = true;
         }
         
-        if(is_running && time_elapsed(tick_diff))
+        // at the lowest quality new generations are drawn every other frame,
+        // moving the view is still followed every frame
+        int cell_shape = quality.level >= QUALITY_SQUARES ? SQUARE : config.cell_shape;
+        Texture2D shape = { 0 };
+        if(cell_shape != SQUARE)
+            shape = shape_texture(shape_textures, cell_shape);
+        if(cell_shape != SQUARE && shape.id == 0)
+            cell_shape = config.cell_shape = SQUARE;
+        bool skip_frame = quality.level >= QUALITY_HALF_RATE && frame % 2 == 1;
+        if(view_changed || (board_changed && !skip_frame))
         {
-            for(int i = 0 ; i < GRID_H ; i++)
+            BeginTextureMode(board_view);
+            ClearBackground(config.background);
+            BeginMode2D(camera);
+            
+            if(lenia_mode)
+            {
+                lenia_texture_update(board_texture, game);
+                DrawTexturePro(
+                    board_texture,
+                    (Rectangle){ 0, 0, config.grid_w, config.grid_h },
+                    (Rectangle){ 0, 0, config.grid_w * config.cell_size, config.grid_h * config.cell_size },
+                    (Vector2){ 0, 0 }, 0, WHITE
+                );
+            }
+            else if(cell_shape == SQUARE)
+            {
+                if(heatmap)
+                    age_texture_update(board_texture, game);
+                else
+                    board_texture_update(board_texture, game);
+                DrawTexturePro(
+                    board_texture,
+                    (Rectangle){ 0, 0, config.grid_w, config.grid_h },
+                    (Rectangle){ 0, 0, config.grid_w * config.cell_size, config.grid_h * config.cell_size },
+                    (Vector2){ 0, 0 }, 0, WHITE
+                );
+            }
+            else
+            {
+                draw_cell_shapes(shape, camera);
+            }
+            
+            // left border
+            DrawLine(
+                    0, 0,
+                    (config.cell_size * config.grid_w), 0,
+                    config.border_color
+            );
+            // right border
+            DrawLine(
+                0, (config.grid_h * config.cell_size),
+                (config.cell_size * config.grid_w), (config.grid_h * config.cell_size),
+                config.border_color
+            );
+            // top border
+            DrawLine(
+                0, 0,
+                0, (config.cell_size * config.grid_h),
+                config.border_color
+            );
+            // bottom border
+            DrawLine(
+                (config.grid_w * config.cell_size), 0,
+                (config.grid_w * config.cell_size), (config.cell_size * config.grid_h),
+                config.border_color
+            );
+            
+            // grid lines fade out once cells get smaller than LINE_FADE_PX on screen
+            float line_fade = Clamp((config.cell_size * camera.zoom - LINE_FADE_PX / 2) / (LINE_FADE_PX / 2), 0, 1);
+            if(config.line_color.a != 0 && line_fade > 0 && quality.level < QUALITY_NO_LINES)
             {
-                for(int j = 0 ; j < GRID_W ; j++)
+                if(line_shader.id == 0)
                 {
-                    bool cell_state = (*current_grid)[i][j];
-                    Neighbors nbors = get_neighbors(current_grid, j, i);
-                    bool next_cell_state = new_state(cell_state, nbors);
-                    (*other_grid)[i][j] = next_cell_state;
+                    line_shader = LoadShaderFromMemory(NULL, grid_line_fs);
+                    Vector2 grid_size = { config.grid_w, config.grid_h };
+                    Vector4 line_color = ColorNormalize(config.line_color);
+                    SetShaderValue(line_shader, GetShaderLocation(line_shader, "gridSize"), &grid_size, SHADER_UNIFORM_VEC2);
+                    SetShaderValue(line_shader, GetShaderLocation(line_shader, "lineColor"), &line_color, SHADER_UNIFORM_VEC4);
+                    line_fade_loc = GetShaderLocation(line_shader, "fade");
                 }
+                SetShaderValue(line_shader, line_fade_loc, &line_fade, SHADER_UNIFORM_FLOAT);
+                BeginShaderMode(line_shader);
+                DrawTexturePro(
+                    (Texture2D){ rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 },
+                    (Rectangle){ 0, 0, 1, 1 },
+                    (Rectangle){ 0, 0, config.grid_w * config.cell_size, config.grid_h * config.cell_size },
+                    (Vector2){ 0, 0 }, 0, WHITE
+                );
+                EndShaderMode();
             }
             
-            // swapping the matrices
-            void *temp = current_grid;
-            current_grid = other_grid;
-            other_grid = temp;
+            EndMode2D();
+            EndTextureMode();
+            
+            drawn_camera = camera;
+            board_changed = false;
+        }
+        
+        BeginDrawing();
+        
+        // render textures are stored upside down
+        DrawTextureRec(
+            board_view.texture,
+            (Rectangle){ 0, 0, board_view.texture.width, -board_view.texture.height },
+            (Vector2){ 0, 0 }, WHITE
+        );
+        
+        BeginMode2D(camera);
+        if(has_selection)
+        {
+            int x0 = select_x0 < select_x1 ? select_x0 : select_x1;
+            int y0 = select_y0 < select_y1 ? select_y0 : select_y1;
+            DrawRectangleLines(
+                x0 * config.cell_size, y0 * config.cell_size,
+                (abs(select_x1 - select_x0) + 1) * config.cell_size, (abs(select_y1 - select_y0) + 1) * config.cell_size,
+                config.border_color
+            );
+        }
+        
+        // Color the hovered cell, or the brush / rectangle being edited
+        if(placing >= 0)
+        {
+            int x0 = hovered_cellx - place_pattern.w / 2;
+            int y0 = hovered_celly - place_pattern.h / 2;
+            for(int i = 0 ; i < place_pattern.h ; i++)
+                for(int j = 0 ; j < place_pattern.w ; j++)
+                    if(gol_pattern_get(&place_pattern, j, i))
+                        DrawRectangle((x0 + j) * config.cell_size, (y0 + i) * config.cell_size, config.cell_size, config.cell_size, ColorAlpha(config.hover_color, 0.5));
+        }
+        else if(rect_dragging)
+        {
+            int x0 = rect_x < hovered_cellx ? rect_x : hovered_cellx;
+            int y0 = rect_y < hovered_celly ? rect_y : hovered_celly;
+            int x1 = rect_x > hovered_cellx ? rect_x : hovered_cellx;
+            int y1 = rect_y > hovered_celly ? rect_y : hovered_celly;
+            DrawRectangleLines(x0 * config.cell_size, y0 * config.cell_size, (x1 - x0 + 1) * config.cell_size, (y1 - y0 + 1) * config.cell_size, config.hover_color);
+        }
+        else
+        {
+            DrawRectangle(
+                (hovered_cellx - brush_radius) * config.cell_size, (hovered_celly - brush_radius) * config.cell_size,
+                (2 * brush_radius + 1) * config.cell_size, (2 * brush_radius + 1) * config.cell_size,
+                ColorAlpha(config.hover_color, 0.5)
+            );
         }
         
         EndMode2D();
+        
+        if(panel_open)
+        {
+            catalog_draw_panel(&catalog, panel_scroll, placing);
+        }
+        
+        int history_count = gol_history_count(game);
+        int history_cursor = gol_history_cursor(game);
+        if(history_count > 0 && history_cursor < history_count - 1)
+        {
+            DrawText(
+                TextFormat("generation %ld (history %d/%d)", gol_stats(game).generation, history_cursor + 1, history_count),
+                10, 10, 20, config.hover_color
+            );
+        }
+        
+        if(lenia_mode)
+        {
+            GolLenia lenia = gol_lenia(game);
+            DrawText(
+                TextFormat("lenia mu %.3f sigma %.3f dt %.2f radius %d", lenia.mu, lenia.sigma, lenia.dt, lenia.radius),
+                10, GetScreenHeight() - 30, 20, config.hover_color
+            );
+        }
+        
+        // EndDrawing waits for the next frame, only the work before it counts
+        if(quality_update(&quality, (draw_start - step_start) * 1000, (GetTime() - draw_start) * 1000))
+            board_changed = true;
+        frame++;
+        
         EndDrawing();
+        if(!presented)
+        {
+            startup_mark("first frame");
+            presented = true;
+        }
     }
     
+    UnloadTexture(board_texture);
+    for(int i = 0 ; i < SHAPE_COUNT ; i++)
+        if(shape_textures[i].id != 0)
+            UnloadTexture(shape_textures[i]);
+    UnloadRenderTexture(board_view);
+    if(line_shader.id != 0)
+        UnloadShader(line_shader);
+    catalog_free(&catalog);
+    CloseWindow();
+    for(int i = 0 ; i < edits.count ; i++)
+        gol_pattern_free(&edits.edits[i].pattern);
+    free(edits.edits);
+    gol_pattern_free(&glider);
+    gol_pattern_free(&clip);
+    gol_pattern_free(&place_pattern);
+    gol_destroy(game);
+    
     return 0;
 }
 
-Neighbors get_neighbors(bool(*game_grid)[GRID_H][GRID_W], int x, int y)
+// defaults from the #defines above, then CONFIG_FILE (or the file given with --config=path),
+// then every --key=value argument. the options are taken out of argv so the
+// subcommands only see their own arguments.
+bool config_load(Config *config, int *argc, char **argv)
 {
-    Neighbors ret = { 0 };
+    *config = (Config){
+        .grid_w = GRID_W,
+        .grid_h = GRID_H,
+        .cell_size = CELL_SIZE,
+        .cell_shape = CELL_SHAPE,
+        .background = BACKGROUND,
+        .line_color = LINE_COLOR,
+        .border_color = BORDER_COLOR,
+        .cell_color = CELL_COLOR,
+        .hover_color = HOVER_COLOR,
+        .engine = GOL_ENGINE_AUTO,
+        .threads = 1,
+        .temporal_steps = GOL_TEMPORAL_STEPS,
+        .lenia = { LENIA_MU, LENIA_SIGMA, LENIA_DT, LENIA_RADIUS },
+        .boundary = TORUS,
+        .seed = 0,
+        .threshold = 128,
+        .msaa = true,
+        .autostart = false,
+        .fps = TARGET_FPS,
+        .adaptive = true,
+    };
+    snprintf(config->rule, sizeof(config->rule), "%s", RULE);
     
-    int y_from_bottom     = GRID_H - y;
-    int x_from_right      = GRID_W - x;
+    const char *path = NULL;
+    for(int i = 1 ; i < *argc ; i++)
+        if(strncmp(argv[i], "--config=", 9) == 0)
+            path = argv[i] + 9;
     
-    int top_neighbor_y    = GRID_H - (y_from_bottom % GRID_H) - 1;
-    int bottom_neighbor_y = (y + 1) % GRID_H;
-    int right_neighbor_x  = (x + 1) % GRID_W;
-    int left_neighbor_x   = GRID_W - (x_from_right % GRID_W) - 1;
+    if(path == NULL && FileExists(CONFIG_FILE))
+        path = CONFIG_FILE;
+    if(path != NULL && !config_read_file(config, path))
+        return false;
     
-    ret.n1 = (*game_grid)[top_neighbor_y][x];
-    ret.n2 = (*game_grid)[top_neighbor_y][right_neighbor_x];
-    ret.n3 = (*game_grid)[y][right_neighbor_x];
-    ret.n4 = (*game_grid)[bottom_neighbor_y][right_neighbor_x];
-    ret.n5 = (*game_grid)[bottom_neighbor_y][x];
-    ret.n6 = (*game_grid)[bottom_neighbor_y][left_neighbor_x];
-    ret.n7 = (*game_grid)[y][left_neighbor_x];
-    ret.n8 = (*game_grid)[top_neighbor_y][left_neighbor_x];
+    int kept = 1;
+    for(int i = 1 ; i < *argc ; i++)
+    {
+        if(strncmp(argv[i], "--", 2) != 0)
+        {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        if(strncmp(argv[i], "--config=", 9) == 0)
+            continue;
+        
+        const char *equals = strchr(argv[i], '=');
+        char key[64];
+        if(equals == NULL || equals - argv[i] - 2 >= (long)sizeof(key))
+        {
+            TraceLog(LOG_ERROR, "CONFIG: expected --key=value, got \"%s\"", argv[i]);
+            return false;
+        }
+        snprintf(key, sizeof(key), "%.*s", (int)(equals - argv[i] - 2), argv[i] + 2);
+        if(!config_set(config, key, equals + 1))
+            return false;
+    }
+    *argc = kept;
+    argv[kept] = NULL;
     
-    return ret;
+    return true;
 }
 
-bool new_state(bool is_alive, Neighbors nbrs)
+// "key = value" lines, blank lines, comments starting with # or ; and [section] headers,
+// which are only there for readability
+// the subcommands and every key config_set() takes, with its default
+void config_help(void)
 {
-    union {
-        Neighbors nbrs;
-        unsigned char c;
-    } nbrs_u8;
-    nbrs_u8.nbrs = nbrs;
-    
-    int count =
-#ifdef _MSC_VER
-__popcnt(nbrs_u8.c);
-#else
-__builtin_popcount(nbrs_u8.c);
-#endif
-    
-    if(is_alive && (count == 2 || count == 3))
+    printf(
+        "usage: gol [--key=value ...] [command]\n"
+        "  (no command)                    open the window\n"
+        "  bench [generations] [k]         time the tiled kernel at k = 1 and at k\n"
+        "  verify [generations]            check every engine against the reference\n"
+        "  stream <in.pbm> <out.pbm> [generations]\n"
+        "                                  step a board file without loading it\n"
+        "  serve [port] [generations per second]\n"
+        "                                  watch a run from a browser\n"
+        "  record <out.gif | out.rgb | -> [frames] [generations per frame] [pixels per cell]\n"
+        "\n"
+        "keys, read from " CONFIG_FILE " (or --config=path) and then from the arguments:\n"
+        "  width, height     board size in cells                     %d, %d\n"
+        "  rule              B/S, Generations, Larger than Life      %s\n"
+        "  boundary          torus, the only one there is            torus\n"
+        "  seed              random seed, 0 seeds from the clock     0\n"
+        "  load              start from a PBM, RLE or image file\n"
+        "  threshold         image pixels darker than this are live  128\n"
+        "  engine            auto, reference, tiled, packed, lenia   auto\n"
+        "  threads           threads stepping the board              1\n"
+        "  temporal_steps    generations per tile pass               %d\n"
+        "  autostart         on, off                                 off\n"
+        "  lenia_radius      kernel radius in cells, at least 2      %d\n"
+        "  lenia_mu          potential of fastest growth             %g\n"
+        "  lenia_sigma       width of the growth bump                %g\n"
+        "  lenia_dt          time step, at most 1                    %g\n"
+        "  cell_size         pixels per cell                         %g\n"
+        "  msaa              on, off                                 on\n"
+        "  fps               frame rate to hold, 0 for unlimited     %d\n"
+        "  adaptive          on, off                                 on\n"
+        "  cell_shape        circle, square, triangle, custom        circle\n"
+        "  cell_image        image of the custom shape\n"
+        "  background, line_color, border_color, cell_color, hover_color\n"
+        "                    raylib color names or #rrggbb / #rrggbbaa\n",
+        GRID_W, GRID_H, RULE, GOL_TEMPORAL_STEPS, LENIA_RADIUS, LENIA_MU, LENIA_SIGMA, LENIA_DT, CELL_SIZE, TARGET_FPS
+    );
+}
+
+bool config_read_file(Config *config, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if(file == NULL)
     {
-        return true;
+        TraceLog(LOG_ERROR, "CONFIG: could not open %s", path);
+        return false;
     }
-    if(!is_alive && count == 3)
+    
+    char line[1024];
+    int number = 0;
+    bool ok = true;
+    while(ok && fgets(line, sizeof(line), file) != NULL)
     {
-        return true;
+        number++;
+        
+        char *start = line;
+        while(*start == ' ' || *start == '\t')
+            start++;
+        char *end = start + strlen(start);
+        while(end > start && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+            end--;
+        *end = '\0';
+        
+        if(*start == '\0' || *start == '#' || *start == ';' || *start == '[')
+            continue;
+        
+        char *equals = strchr(start, '=');
+        if(equals == NULL)
+        {
+            TraceLog(LOG_ERROR, "CONFIG: %s:%d: expected key = value", path, number);
+            ok = false;
+            break;
+        }
+        
+        char *key_end = equals;
+        while(key_end > start && (key_end[-1] == ' ' || key_end[-1] == '\t'))
+            key_end--;
+        *key_end = '\0';
+        
+        char *value = equals + 1;
+        while(*value == ' ' || *value == '\t')
+            value++;
+        if(*value == '"' && end > value + 1 && end[-1] == '"')
+        {
+            value++;
+            end[-1] = '\0';
+        }
+        
+        ok = config_set(config, start, value);
+        if(!ok)
+            TraceLog(LOG_ERROR, "CONFIG: in %s:%d", path, number);
     }
     
-    return false;
+    fclose(file);
+    return ok;
 }
 
-void iclamp(int *num, int min, int max)
+// index of `text` in `names` (any case), -1 if it isn't there
+static int parse_name(const char *text, const char **names, int count)
 {
-    if(*num > max)
-        *num = max;
-    else if(*num < min)
-        *num = min;
+    const char *lower = TextToLower(text);
+    for(int i = 0 ; i < count ; i++)
+        if(strcmp(lower, names[i]) == 0)
+            return i;
+    return -1;
 }
 
-bool time_elapsed(double seconds)
+bool config_set(Config *config, const char *key, const char *value)
 {
-    static bool first_call = true;
-    static double prev_time;
-    if(first_call)
+    static const char *shape_names[] = { "circle", "square", "triangle", "custom" };
+    static const char *engine_names[] = { "auto", "reference", "tiled", "packed", "lenia" };
+    static const char *boundary_names[] = { "torus" };
+    static const char *switch_names[] = { "off", "on" };
+    
+    char *end;
+    bool ok = true;
+    if(strcmp(key, "width") == 0 || strcmp(key, "height") == 0)
     {
-        first_call = false;
-        prev_time = GetTime();
-        return true;
+        long n = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && n >= 1 && n <= 1 << 17;
+        if(ok && key[0] == 'w')
+            config->grid_w = n;
+        else if(ok)
+            config->grid_h = n;
     }
-    
-    double now = GetTime();
-    if((now - prev_time) >= seconds)
+    else if(strcmp(key, "cell_size") == 0)
     {
-        prev_time = now;
-        return true;
+        float size = strtof(value, &end);
+        ok = end != value && *end == '\0' && size > 0;
+        if(ok)
+            config->cell_size = size;
     }
-    
-    return false;
+    else if(strcmp(key, "cell_shape") == 0)
+    {
+        int shape = parse_name(value, shape_names, SHAPE_COUNT);
+        ok = shape >= 0;
+        if(ok)
+            config->cell_shape = shape;
+    }
+    else if(strcmp(key, "background") == 0)
+        ok = parse_color(value, &config->background);
+    else if(strcmp(key, "line_color") == 0)
+        ok = parse_color(value, &config->line_color);
+    else if(strcmp(key, "border_color") == 0)
+        ok = parse_color(value, &config->border_color);
+    else if(strcmp(key, "cell_color") == 0)
+        ok = parse_color(value, &config->cell_color);
+    else if(strcmp(key, "hover_color") == 0)
+        ok = parse_color(value, &config->hover_color);
+    else if(strcmp(key, "rule") == 0)
+    {
+        ok = strlen(value) < sizeof(config->rule) && gol_rule_valid(value);
+        if(ok)
+            snprintf(config->rule, sizeof(config->rule), "%s", value);
+    }
+    else if(strcmp(key, "engine") == 0)
+    {
+        int engine = parse_name(value, engine_names, 5);
+        ok = engine >= 0;
+        if(ok)
+            config->engine = engine;
+    }
+    else if(strcmp(key, "threads") == 0)
+    {
+        long threads = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && threads >= 1 && threads <= GOL_MAX_THREADS;
+        if(ok)
+            config->threads = threads;
+    }
+    else if(strcmp(key, "temporal_steps") == 0)
+    {
+        long steps = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && steps >= 1 && steps <= GOL_TILE_SIZE / 2;
+        if(ok)
+            config->temporal_steps = steps;
+    }
+    else if(strcmp(key, "lenia_radius") == 0)
+    {
+        long radius = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && radius >= 2 && radius <= 1 << 16;
+        if(ok)
+            config->lenia.radius = radius;
+    }
+    else if(strcmp(key, "lenia_mu") == 0 || strcmp(key, "lenia_sigma") == 0 || strcmp(key, "lenia_dt") == 0)
+    {
+        float v = strtof(value, &end);
+        ok = end != value && *end == '\0' && v > 0 && (key[6] != 'd' || v <= 1);
+        if(ok && key[6] == 'm')
+            config->lenia.mu = v;
+        else if(ok && key[6] == 's')
+            config->lenia.sigma = v;
+        else if(ok)
+            config->lenia.dt = v;
+    }
+    else if(strcmp(key, "boundary") == 0)
+    {
+        // the board is a torus everywhere, there's nothing else to pick yet
+        int boundary = parse_name(value, boundary_names, 1);
+        ok = boundary >= 0;
+        if(ok)
+            config->boundary = boundary;
+    }
+    else if(strcmp(key, "seed") == 0)
+    {
+        unsigned long seed = strtoul(value, &end, 10);
+        ok = end != value && *end == '\0';
+        if(ok)
+            config->seed = seed;
+    }
+    else if(strcmp(key, "msaa") == 0 || strcmp(key, "autostart") == 0 || strcmp(key, "adaptive") == 0)
+    {
+        int on = parse_name(value, switch_names, 2);
+        ok = on >= 0;
+        if(ok && key[0] == 'm')
+            config->msaa = on;
+        else if(ok && key[1] == 'u')
+            config->autostart = on;
+        else if(ok)
+            config->adaptive = on;
+    }
+    else if(strcmp(key, "fps") == 0)
+    {
+        long fps = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && fps >= 0 && fps <= 1000;
+        if(ok)
+            config->fps = fps;
+    }
+    else if(strcmp(key, "cell_image") == 0)
+    {
+        ok = strlen(value) < sizeof(config->cell_image);
+        if(ok)
+            snprintf(config->cell_image, sizeof(config->cell_image), "%s", value);
+    }
+    else if(strcmp(key, "load") == 0)
+    {
+        ok = strlen(value) < sizeof(config->load);
+        if(ok)
+            snprintf(config->load, sizeof(config->load), "%s", value);
+    }
+    else if(strcmp(key, "threshold") == 0)
+    {
+        long threshold = strtol(value, &end, 10);
+        ok = end != value && *end == '\0' && threshold >= 1 && threshold <= 256;
+        if(ok)
+            config->threshold = threshold;
+    }
+    else
+    {
+        TraceLog(LOG_ERROR, "CONFIG: unknown setting \"%s\"", key);
+        return false;
+    }
+    
+    if(!ok)
+        TraceLog(LOG_ERROR, "CONFIG: bad value \"%s\" for %s", value, key);
+    return ok;
+}
+
+// a raylib color name ("orange", "skyblue", ...) or #rrggbb / #rrggbbaa
+bool parse_color(const char *text, Color *out)
+{
+    static const struct {
+        const char *name;
+        Color color;
+    } named[] = {
+        { "lightgray", LIGHTGRAY }, { "gray", GRAY }, { "darkgray", DARKGRAY }, { "yellow", YELLOW },
+        { "gold", GOLD }, { "orange", ORANGE }, { "pink", PINK }, { "red", RED },
+        { "maroon", MAROON }, { "green", GREEN }, { "lime", LIME }, { "darkgreen", DARKGREEN },
+        { "skyblue", SKYBLUE }, { "blue", BLUE }, { "darkblue", DARKBLUE }, { "purple", PURPLE },
+        { "violet", VIOLET }, { "darkpurple", DARKPURPLE }, { "beige", BEIGE }, { "brown", BROWN },
+        { "darkbrown", DARKBROWN }, { "white", WHITE }, { "black", BLACK }, { "blank", BLANK },
+        { "magenta", MAGENTA }, { "raywhite", RAYWHITE },
+    };
+    
+    if(text[0] == '#')
+    {
+        char *end;
+        unsigned long hex = strtoul(text + 1, &end, 16);
+        size_t digits = end - (text + 1);
+        if(*end != '\0' || (digits != 6 && digits != 8))
+            return false;
+        *out = GetColor(digits == 6 ? (unsigned int)(hex << 8 | 0xff) : (unsigned int)hex);
+        return true;
+    }
+    
+    const char *lower = TextToLower(text);
+    for(size_t i = 0 ; i < sizeof(named) / sizeof(named[0]) ; i++)
+    {
+        if(strcmp(lower, named[i].name) == 0)
+        {
+            *out = named[i].color;
+            return true;
+        }
+    }
+    return false;
+}
+
+// a board the size of the image. PBM files are streamed straight into the cells, any other
+// image raylib reads is turned to grayscale and pixels darker than config.threshold are live,
+// so black on white drawings load the same either way
+GolBoard *board_load(const char *path)
+{
+    if(IsFileExtension(path, ".pbm"))
+        return gol_load_pbm(path, config.rule);
+    
+    Image image = LoadImage(path);
+    if(!IsImageReady(image))
+    {
+        TraceLog(LOG_ERROR, "BOARD: could not load %s", path);
+        return NULL;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+    
+    GolBoard *board = gol_create(image.width, image.height, config.rule);
+    if(board != NULL)
+    {
+        const unsigned char *pixels = image.data;
+        bool *cells = gol_cells(board);
+        for(int i = 0 ; i < image.width * image.height ; i++)
+            cells[i] = pixels[i] < config.threshold;
+        gol_cells_changed(board, 0, 0, image.width - 1, image.height - 1);
+    }
+    UnloadImage(image);
+    return board;
+}
+
+// the board of the config, loaded or empty, on the configured engine
+GolBoard *board_setup(void)
+{
+    GolBoard *board = config.load[0] != '\0' ? board_load(config.load) : gol_create(config.grid_w, config.grid_h, config.rule);
+    if(board == NULL)
+        return NULL;
+    gol_set_lenia(board, config.lenia);
+    if(!gol_set_engine(board, config.engine))
+    {
+        TraceLog(LOG_ERROR, "CONFIG: rule \"%s\" needs engine = auto", config.rule);
+        gol_destroy(board);
+        return NULL;
+    }
+    gol_set_threads(board, config.threads);
+    gol_set_temporal_steps(board, config.temporal_steps);
+    return board;
+}
+
+// with autostart the board runs at GENS_PER_SEC until the window is up,
+// from there on the main loop's scheduler takes over
+void *startup_thread(void *arg)
+{
+    Startup *startup = arg;
+    GolBoard *board = board_setup();
+    if(board != NULL)
+        gol_history_enable(board, (size_t)HISTORY_BUDGET_MB * 1024 * 1024, HISTORY_KEYFRAME_INTERVAL);
+    startup_mark("board ready");
+    
+    double start = startup_seconds();
+    while(board != NULL && config.autostart && !atomic_load(&startup->window_ready))
+    {
+        long due = (startup_seconds() - start) * GENS_PER_SEC - startup->generations;
+        if(due > 0)
+            startup->generations += gol_step(board, due);
+        else
+            WaitTime(0.001);
+    }
+    if(startup->generations > 0)
+        TraceLog(LOG_INFO, "STARTUP: %ld generations run while the window opened", startup->generations);
+    
+    startup->board = board;
+    return NULL;
+}
+
+void startup_mark(const char *phase)
+{
+    TraceLog(LOG_INFO, "STARTUP: %s after %.1f ms", phase, (startup_seconds() - startup_time) * 1000);
+}
+
+double startup_seconds(void)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// large boards start zoomed in on the top left corner rather than with a giant window
+void window_size(int *w, int *h)
+{
+    *w = config.cell_size * config.grid_w;
+    *h = config.cell_size * config.grid_h;
+    if(*w > 1600)
+        *w = 1600;
+    if(*h > 1000)
+        *h = 1000;
+}
+
+// writes board_<generation>.png or .pbm, live cells black as in PBM files. the PNG goes
+// through a one byte per cell grayscale image, larger boards than EXPORT_PNG_MAX_CELLS
+// get the PBM, which is packed and written a row at a time.
+bool board_export(GolBoard *board, bool png)
+{
+    int w = gol_width(board);
+    int h = gol_height(board);
+    if(png && (long)w * h > EXPORT_PNG_MAX_CELLS)
+    {
+        TraceLog(LOG_WARNING, "BOARD: %dx%d is too large for a PNG, writing a PBM", w, h);
+        png = false;
+    }
+    
+    const char *path = TextFormat("board_%ld.%s", gol_stats(board).generation, png ? "png" : "pbm");
+    bool ok;
+    if(png)
+    {
+        const bool *cells = gol_cells(board);
+        unsigned char *pixels = malloc((size_t)w * h);
+        for(size_t i = 0 ; i < (size_t)w * h ; i++)
+            pixels[i] = cells[i] ? 0 : 255;
+        Image image = { pixels, w, h, 1, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE };
+        ok = ExportImage(image, path);
+        free(pixels);
+    }
+    else
+        ok = gol_save_pbm(board, path);
+    
+    if(ok)
+        TraceLog(LOG_INFO, "BOARD: saved %s", path);
+    else
+        TraceLog(LOG_ERROR, "BOARD: could not save %s", path);
+    return ok;
+}
+
+// from white hot for cells that were just born through orange and red to a deep blue for
+// cells that have been alive for 255 generations, on a log scale so the first few dozen
+// generations (where most of the churn is) get most of the range
+void heat_palette_init(void)
+{
+    static const Color stops[] = {
+        { 255, 255, 210, 255 }, { 255, 210, 40, 255 }, { 255, 90, 0, 255 },
+        { 190, 20, 80, 255 }, { 90, 20, 150, 255 }, { 20, 40, 160, 255 },
+    };
+    int segments = sizeof(stops) / sizeof(stops[0]) - 1;
+    for(int age = 0 ; age < 256 ; age++)
+    {
+        float t = age <= 1 ? 0 : logf(age) / logf(255) * segments;
+        int i = t >= segments ? segments - 1 : (int)t;
+        Color from = stops[i];
+        Color to = stops[i + 1];
+        t -= i;
+        heat_palette[age] = (Color){
+            from.r + (to.r - from.r) * t,
+            from.g + (to.g - from.g) * t,
+            from.b + (to.b - from.b) * t,
+            255
+        };
+    }
+}
+
+// live cells get config.cell_color, dying ones fade towards the background as they age
+Color state_color(int state)
+{
+    if(state == 0)
+        return BLANK;
+    
+    float t = (float)(state - 1) / (gol_rule_states(game) - 1);
+    Color from = config.cell_color;
+    Color to = config.background;
+    return (Color){
+        from.r + (to.r - from.r) * t,
+        from.g + (to.g - from.g) * t,
+        from.b + (to.b - from.b) * t,
+        255
+    };
+}
+
+// every cell changes color as it ages, so the whole board is uploaded
+void age_texture_update(Texture2D texture, GolBoard *board)
+{
+    const bool *cells = gol_cells(board);
+    const unsigned char *age = gol_age(board);
+    int count = gol_width(board) * gol_height(board);
+    Color *pixels = malloc((size_t)count * sizeof(Color));
+    for(int i = 0 ; i < count ; i++)
+        pixels[i] = cells[i] ? heat_palette[age[i]] : BLANK;
+    UpdateTexture(texture, pixels);
+    free(pixels);
+}
+
+void lenia_texture_update(Texture2D texture, GolBoard *board)
+{
+    const float *cells = gol_lenia_cells(board);
+    if(cells == NULL)
+        return;
+    int count = gol_width(board) * gol_height(board);
+    Color *pixels = malloc((size_t)count * sizeof(Color));
+    for(int i = 0 ; i < count ; i++)
+        pixels[i] = ColorAlpha(config.cell_color, cells[i]);
+    UpdateTexture(texture, pixels);
+    free(pixels);
+}
+
+// a cell's shape, white with the coverage in alpha so it can be tinted with any cell color.
+// every texel averages 4 x 4 samples for smooth edges, and the mipmaps keep them smooth when
+// cells are only a few pixels on screen. custom shapes are config.cell_image scaled down,
+// and an id of 0 when it can't be read.
+Texture2D shape_texture(Texture2D *textures, int shape)
+{
+    if(textures[shape].id != 0)
+        return textures[shape];
+    
+    Image image;
+    if(shape == CUSTOM)
+    {
+        image = LoadImage(config.cell_image);
+        if(!IsImageReady(image))
+        {
+            TraceLog(LOG_WARNING, "SHAPE: could not load %s, drawing squares", config.cell_image);
+            return textures[shape];
+        }
+        ImageResize(&image, SHAPE_TEXTURE_SIZE, SHAPE_TEXTURE_SIZE);
+    }
+    else
+    {
+        image = GenImageColor(SHAPE_TEXTURE_SIZE, SHAPE_TEXTURE_SIZE, BLANK);
+        Color *pixels = image.data;
+        for(int y = 0 ; y < SHAPE_TEXTURE_SIZE ; y++)
+        {
+            for(int x = 0 ; x < SHAPE_TEXTURE_SIZE ; x++)
+            {
+                int inside = 0;
+                for(int i = 0 ; i < 16 ; i++)
+                {
+                    float u = (x + (i % 4 + 0.5f) / 4) / SHAPE_TEXTURE_SIZE;
+                    float v = (y + (i / 4 + 0.5f) / 4) / SHAPE_TEXTURE_SIZE;
+                    if(shape == CIRCLE)
+                        inside += (u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f) <= 0.25f;
+                    else
+                        inside += v >= 2 * fabsf(u - 0.5f);
+                }
+                pixels[y * SHAPE_TEXTURE_SIZE + x] = (Color){ 255, 255, 255, inside * 255 / 16 };
+            }
+        }
+    }
+    
+    textures[shape] = LoadTextureFromImage(image);
+    UnloadImage(image);
+    GenTextureMipmaps(&textures[shape]);
+    SetTextureFilter(textures[shape], TEXTURE_FILTER_TRILINEAR);
+    return textures[shape];
+}
+
+// every live cell in view as a quad of `texture`. all of them share the texture, so raylib
+// keeps them in one draw call until its vertex buffer is full, which is checked once per
+// SHAPE_BATCH quads rather than per cell.
+void draw_cell_shapes(Texture2D texture, Camera2D camera)
+{
+    Vector2 from = GetScreenToWorld2D((Vector2){ 0, 0 }, camera);
+    Vector2 to = GetScreenToWorld2D((Vector2){ GetScreenWidth(), GetScreenHeight() }, camera);
+    float size = config.cell_size;
+    int x0 = from.x / size;
+    int y0 = from.y / size;
+    int x1 = to.x / size;
+    int y1 = to.y / size;
+    iclamp(&x0, 0, config.grid_w - 1);
+    iclamp(&y0, 0, config.grid_h - 1);
+    iclamp(&x1, 0, config.grid_w - 1);
+    iclamp(&y1, 0, config.grid_h - 1);
+    
+    const bool *cells = gol_cells(game);
+    const unsigned char *age = gol_age(game);
+    bool multi_state = gol_rule_states(game) > 2;
+    bool open = false;
+    int quads = 0;
+    for(int y = y0 ; y <= y1 ; y++)
+    {
+        for(int x = x0 ; x <= x1 ; x++)
+        {
+            int state = multi_state ? gol_state(game, x, y) : cells[(size_t)y * config.grid_w + x];
+            if(state == 0)
+                continue;
+            
+            if(!open || quads == SHAPE_BATCH)
+            {
+                if(open)
+                    rlEnd();
+                rlCheckRenderBatchLimit(4 * SHAPE_BATCH);
+                rlSetTexture(texture.id);
+                rlBegin(RL_QUADS);
+                open = true;
+                quads = 0;
+            }
+            
+            Color color = multi_state ? state_color(state) : config.cell_color;
+            if(heatmap)
+                color = heat_palette[age[(size_t)y * config.grid_w + x]];
+            rlColor4ub(color.r, color.g, color.b, color.a);
+            rlTexCoord2f(0, 0);
+            rlVertex2f(x * size, y * size);
+            rlTexCoord2f(0, 1);
+            rlVertex2f(x * size, (y + 1) * size);
+            rlTexCoord2f(1, 1);
+            rlVertex2f((x + 1) * size, (y + 1) * size);
+            rlTexCoord2f(1, 0);
+            rlVertex2f((x + 1) * size, y * size);
+            quads++;
+        }
+    }
+    if(open)
+        rlEnd();
+    rlSetTexture(0);
+}
+
+// uploads the tiles libgol flagged as changed, or the whole board after bulk changes
+void board_texture_update(Texture2D texture, GolBoard *board)
+{
+    static Color pixels[GOL_TILE_SIZE * GOL_TILE_SIZE];
+    bool *dirty_tiles = gol_dirty_tiles(board);
+    
+    if(dirty_full)
+    {
+        Color *all = malloc(config.grid_w * config.grid_h * sizeof(Color));
+        for(int i = 0 ; i < config.grid_w * config.grid_h ; i++)
+            all[i] = state_color(gol_state(board, i % config.grid_w, i / config.grid_w));
+        UpdateTexture(texture, all);
+        free(all);
+        
+        memset(dirty_tiles, 0, TILES_X * TILES_Y);
+        dirty_full = false;
+        return;
+    }
+    
+    for(int ty = 0 ; ty < TILES_Y ; ty++)
+    {
+        for(int tx = 0 ; tx < TILES_X ; tx++)
+        {
+            if(!dirty_tiles[ty * TILES_X + tx])
+                continue;
+            dirty_tiles[ty * TILES_X + tx] = false;
+            
+            int x0 = tx * GOL_TILE_SIZE;
+            int y0 = ty * GOL_TILE_SIZE;
+            int tw = config.grid_w - x0 < GOL_TILE_SIZE ? config.grid_w - x0 : GOL_TILE_SIZE;
+            int th = config.grid_h - y0 < GOL_TILE_SIZE ? config.grid_h - y0 : GOL_TILE_SIZE;
+            
+            for(int i = 0 ; i < th ; i++)
+                for(int j = 0 ; j < tw ; j++)
+                    pixels[i * tw + j] = state_color(gol_state(board, x0 + j, y0 + i));
+            
+            UpdateTextureRec(texture, (Rectangle){ x0, y0, tw, th }, pixels);
+        }
+    }
+}
+
+void edit_push(EditBatch *batch, Edit edit)
+{
+    if(batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity ? batch->capacity * 2 : 64;
+        batch->edits = realloc(batch->edits, batch->capacity * sizeof(Edit));
+    }
+    batch->edits[batch->count++] = edit;
+}
+
+// a brush stroke from (x0, y0) to (x1, y1), every cell within `radius` of the line
+void edit_line(EditBatch *batch, int x0, int y0, int x1, int y1, int radius, bool value)
+{
+    edit_push(batch, (Edit){ .kind = EDIT_LINE, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .radius = radius, .value = value });
+}
+
+void edit_rect(EditBatch *batch, int x0, int y0, int x1, int y1, bool value)
+{
+    Edit edit = { .kind = EDIT_RECT, .value = value };
+    edit.x0 = x0 < x1 ? x0 : x1;
+    edit.y0 = y0 < y1 ? y0 : y1;
+    edit.x1 = x0 > x1 ? x0 : x1;
+    edit.y1 = y0 > y1 ? y0 : y1;
+    edit_push(batch, edit);
+}
+
+// copies a pattern onto the board with its top left corner at (x, y), wrapping around the edges
+void edit_stamp(EditBatch *batch, int x, int y, const GolPattern *pattern)
+{
+    Edit edit = { .kind = EDIT_STAMP, .x0 = x, .y0 = y };
+    edit.x1 = x + pattern->w - 1;
+    edit.y1 = y + pattern->h - 1;
+    edit.pattern = gol_pattern_clone(pattern);
+    edit_push(batch, edit);
+}
+
+static void edit_brush(GolBoard *board, int x, int y, int radius, bool value)
+{
+    bool *cells = gol_cells(board);
+    int x0 = x - radius;
+    int x1 = x + radius;
+    iclamp(&x0, 0, config.grid_w - 1);
+    iclamp(&x1, 0, config.grid_w - 1);
+    
+    for(int i = y - radius ; i <= y + radius ; i++)
+        if(i >= 0 && i < config.grid_h)
+            memset(cells + i * config.grid_w + x0, value, x1 - x0 + 1);
+    
+    gol_cells_changed(board, x0, y - radius, x1, y + radius);
+}
+
+// applies queued edits in order until `budget` cells were written.
+// returns whether the board changed.
+bool edit_batch_apply(EditBatch *batch, GolBoard *board, long budget)
+{
+    bool *cells = gol_cells(board);
+    int done = 0;
+    bool changed = false;
+    
+    bool finished = true;
+    
+    while(done < batch->count && budget > 0 && finished)
+    {
+        Edit *edit = &batch->edits[done];
+        changed = true;
+        
+        switch(edit->kind)
+        {
+            case EDIT_LINE:
+            {
+                // bresenham
+                int dx = abs(edit->x1 - edit->x0);
+                int dy = -abs(edit->y1 - edit->y0);
+                int sx = edit->x0 < edit->x1 ? 1 : -1;
+                int sy = edit->y0 < edit->y1 ? 1 : -1;
+                int err = dx + dy;
+                int x = edit->x0;
+                int y = edit->y0;
+                
+                while(true)
+                {
+                    edit_brush(board, x, y, edit->radius, edit->value);
+                    budget -= (2 * edit->radius + 1) * (2 * edit->radius + 1);
+                    
+                    if(x == edit->x1 && y == edit->y1)
+                        break;
+                    int e2 = 2 * err;
+                    if(e2 >= dy)
+                    {
+                        err += dy;
+                        x += sx;
+                    }
+                    if(e2 <= dx)
+                    {
+                        err += dx;
+                        y += sy;
+                    }
+                }
+                break;
+            }
+            case EDIT_RECT:
+            case EDIT_RANDOMIZE:
+            {
+                int width = edit->x1 - edit->x0 + 1;
+                int y = edit->y0 + edit->progress;
+                for( ; y <= edit->y1 && budget > 0 ; y++)
+                {
+                    bool *row = cells + y * config.grid_w + edit->x0;
+                    if(edit->kind == EDIT_RANDOMIZE)
+                        for(int j = 0 ; j < width ; j++)
+                            row[j] = rand() % 2;
+                    else
+                        memset(row, edit->value, width);
+                    budget -= width;
+                }
+                
+                gol_cells_changed(board, edit->x0, edit->y0 + edit->progress, edit->x1, y - 1);
+                edit->progress = y - edit->y0;
+                finished = y > edit->y1;
+                break;
+            }
+            case EDIT_STAMP:
+            {
+                int i = edit->progress;
+                for( ; i < edit->pattern.h && budget > 0 ; i++)
+                {
+                    int y = gol_wrap(edit->y0 + i, config.grid_h);
+                    gol_pattern_blit_row(&edit->pattern, i, board, edit->x0, y);
+                    budget -= edit->pattern.w;
+                }
+                
+                // the stamp may wrap around the edges, so its bounding box could be split
+                if(edit->pattern.w >= config.grid_w || edit->pattern.h >= config.grid_h || edit->x0 < 0 || edit->y0 < 0 || edit->x1 >= config.grid_w || edit->y1 >= config.grid_h)
+                    gol_cells_changed(board, 0, 0, config.grid_w - 1, config.grid_h - 1);
+                else
+                    gol_cells_changed(board, edit->x0, edit->y0 + edit->progress, edit->x1, edit->y0 + i - 1);
+                
+                edit->progress = i;
+                finished = i >= edit->pattern.h;
+                if(finished)
+                    gol_pattern_free(&edit->pattern);
+                break;
+            }
+        }
+        
+        if(finished)
+            done++;
+    }
+    
+    memmove(batch->edits, batch->edits + done, (batch->count - done) * sizeof(Edit));
+    batch->count -= done;
+    return changed;
+}
+
+static int compare_paths(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static char *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL)
+        return NULL;
+    
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char *data = malloc(length + 1);
+    *size = fread(data, 1, length, file);
+    data[*size] = '\0';
+    fclose(file);
+    return data;
+}
+
+// paths of the .rle files in `dir`, sorted. (raylib's LoadDirectoryFiles()
+// stops being safe past a few thousand files, libraries can be bigger)
+static char **list_rle_files(const char *dir, int *count)
+{
+    int capacity = 256;
+    char **paths = malloc(capacity * sizeof(char*));
+    *count = 0;
+    
+    DIR *d = opendir(dir);
+    if(d == NULL)
+        return paths;
+    
+    struct dirent *item;
+    while((item = readdir(d)) != NULL)
+    {
+        size_t len = strlen(item->d_name);
+        if(len < 5 || strcmp(item->d_name + len - 4, ".rle") != 0)
+            continue;
+        
+        if(*count == capacity)
+        {
+            capacity *= 2;
+            paths = realloc(paths, capacity * sizeof(char*));
+        }
+        paths[*count] = malloc(strlen(dir) + len + 2);
+        sprintf(paths[*count], "%s/%s", dir, item->d_name);
+        (*count)++;
+    }
+    closedir(d);
+    
+    qsort(paths, *count, sizeof(char*), compare_paths);
+    return paths;
+}
+
+// loads every .rle file of `dir`. entries are sorted by path, as is the cache,
+// so both lists are walked side by side.
+void catalog_load(Catalog *catalog, const char *dir)
+{
+    memset(catalog, 0, sizeof(*catalog));
+    if(!DirectoryExists(dir))
+        return;
+    
+    char cache_path[512];
+    snprintf(cache_path, sizeof(cache_path), "%s/.cache", dir);
+    Catalog cache = { 0 };
+    catalog_read_cache(&cache, cache_path);
+    
+    int file_count;
+    char **files = list_rle_files(dir, &file_count);
+    
+    catalog->entries = calloc(file_count ? file_count : 1, sizeof(CatalogEntry));
+    bool cache_stale = cache.count != file_count;
+    int cached = 0;
+    
+    for(int i = 0 ; i < file_count ; i++)
+    {
+        CatalogEntry *entry = &catalog->entries[catalog->count];
+        snprintf(entry->path, sizeof(entry->path), "%s", files[i]);
+        entry->mtime = GetFileModTime(entry->path);
+        
+        while(cached < cache.count && strcmp(cache.entries[cached].path, entry->path) < 0)
+            cached++;
+        CatalogEntry *hit = cached < cache.count && strcmp(cache.entries[cached].path, entry->path) == 0 ? &cache.entries[cached] : NULL;
+        
+        if(hit != NULL && hit->mtime == entry->mtime)
+        {
+            entry->hash = hit->hash;
+            entry->pattern = gol_pattern_clone(&hit->pattern);
+            catalog->count++;
+            continue;
+        }
+        
+        cache_stale = true;
+        size_t size;
+        char *text = read_file(entry->path, &size);
+        if(text == NULL)
+            continue;
+        
+        entry->hash = gol_hash(text, size);
+        if(hit != NULL && hit->hash == entry->hash)
+        {
+            entry->pattern = gol_pattern_clone(&hit->pattern);
+            catalog->count++;
+        }
+        else if(gol_pattern_from_rle(text, &entry->pattern))
+        {
+            catalog->count++;
+        }
+        else
+        {
+            TraceLog(LOG_WARNING, "PATTERNS: %s is not a valid RLE file", entry->path);
+        }
+        free(text);
+    }
+    
+    for(int i = 0 ; i < file_count ; i++)
+        free(files[i]);
+    free(files);
+    
+    if(cache_stale)
+        catalog_write_cache(catalog, cache_path);
+    catalog_free(&cache);
+    
+    TraceLog(LOG_INFO, "PATTERNS: %d patterns loaded from %s", catalog->count, dir);
+}
+
+void catalog_free(Catalog *catalog)
+{
+    for(int i = 0 ; i < catalog->count ; i++)
+    {
+        gol_pattern_free(&catalog->entries[i].pattern);
+        if(catalog->entries[i].thumbnail.id != 0)
+            UnloadTexture(catalog->entries[i].thumbnail);
+    }
+    free(catalog->entries);
+    memset(catalog, 0, sizeof(*catalog));
+}
+
+static bool cache_read(const char **p, const char *end, void *dst, size_t n)
+{
+    if(*p + n > end)
+        return false;
+    memcpy(dst, *p, n);
+    *p += n;
+    return true;
+}
+
+// cache layout: "GOLC", entry count, then per entry the path length, path,
+// modification time, content hash, width, height and the pattern's packed words
+bool catalog_read_cache(Catalog *catalog, const char *path)
+{
+    size_t size;
+    char *data = read_file(path, &size);
+    if(data == NULL)
+        return false;
+    
+    const char *p = data;
+    const char *end = data + size;
+    
+    char magic[4];
+    int32_t count = 0;
+    bool ok = cache_read(&p, end, magic, 4) && cache_read(&p, end, &count, sizeof(count));
+    ok = ok && memcmp(magic, "GOLC", 4) == 0 && count >= 0;
+    
+    if(ok)
+        catalog->entries = calloc(count ? count : 1, sizeof(CatalogEntry));
+    
+    for(int i = 0 ; ok && i < count ; i++)
+    {
+        CatalogEntry *entry = &catalog->entries[i];
+        int32_t path_len, w, h;
+        int64_t mtime;
+        
+        ok = cache_read(&p, end, &path_len, sizeof(path_len)) && path_len >= 0 && path_len < (int)sizeof(entry->path);
+        ok = ok && cache_read(&p, end, entry->path, path_len);
+        ok = ok && cache_read(&p, end, &mtime, sizeof(mtime));
+        ok = ok && cache_read(&p, end, &entry->hash, sizeof(entry->hash));
+        ok = ok && cache_read(&p, end, &w, sizeof(w));
+        ok = ok && cache_read(&p, end, &h, sizeof(h));
+        ok = ok && w > 0 && h > 0;
+        if(!ok)
+            break;
+        
+        entry->mtime = mtime;
+        entry->pattern = gol_pattern_alloc(w, h);
+        catalog->count++;
+        ok = entry->pattern.bits != NULL && cache_read(&p, end, entry->pattern.bits, (size_t)entry->pattern.stride * h * sizeof(uint64_t));
+    }
+    
+    free(data);
+    if(!ok)
+    {
+        TraceLog(LOG_WARNING, "PATTERNS: ignoring corrupt cache %s", path);
+        catalog_free(catalog);
+    }
+    return ok;
+}
+
+void catalog_write_cache(const Catalog *catalog, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if(file == NULL)
+        return;
+    
+    int32_t count = catalog->count;
+    fwrite("GOLC", 1, 4, file);
+    fwrite(&count, sizeof(count), 1, file);
+    
+    for(int i = 0 ; i < catalog->count ; i++)
+    {
+        const CatalogEntry *entry = &catalog->entries[i];
+        int32_t path_len = strlen(entry->path);
+        int64_t mtime = entry->mtime;
+        int32_t w = entry->pattern.w;
+        int32_t h = entry->pattern.h;
+        
+        fwrite(&path_len, sizeof(path_len), 1, file);
+        fwrite(entry->path, 1, path_len, file);
+        fwrite(&mtime, sizeof(mtime), 1, file);
+        fwrite(&entry->hash, sizeof(entry->hash), 1, file);
+        fwrite(&w, sizeof(w), 1, file);
+        fwrite(&h, sizeof(h), 1, file);
+        fwrite(entry->pattern.bits, sizeof(uint64_t), (size_t)entry->pattern.stride * h, file);
+    }
+    
+    fclose(file);
+}
+
+// renders the pattern into a THUMB_SIZE square the first time it's shown.
+// when the pattern is bigger than the thumbnail, any live cell lights its pixel.
+Texture2D catalog_thumbnail(CatalogEntry *entry)
+{
+    if(entry->thumbnail.id != 0)
+        return entry->thumbnail;
+    
+    const GolPattern *pattern = &entry->pattern;
+    int longest = pattern->w > pattern->h ? pattern->w : pattern->h;
+    
+    Image image = GenImageColor(THUMB_SIZE, THUMB_SIZE, BLANK);
+    Color *pixels = image.data;
+    for(int y = 0 ; y < pattern->h ; y++)
+    {
+        for(int x = 0 ; x < pattern->w ; x++)
+        {
+            if(!gol_pattern_get(pattern, x, y))
+                continue;
+            
+            int px0 = x * THUMB_SIZE / longest;
+            int py0 = y * THUMB_SIZE / longest;
+            int px1 = (x + 1) * THUMB_SIZE / longest;
+            int py1 = (y + 1) * THUMB_SIZE / longest;
+            for(int py = py0 ; py < py1 || py == py0 ; py++)
+                for(int px = px0 ; px < px1 || px == px0 ; px++)
+                    pixels[py * THUMB_SIZE + px] = config.cell_color;
+        }
+    }
+    
+    entry->thumbnail = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return entry->thumbnail;
+}
+
+void catalog_draw_panel(Catalog *catalog, int scroll, int selected)
+{
+    int x = GetScreenWidth() - PANEL_W;
+    int entry_h = THUMB_SIZE + 8;
+    DrawRectangle(x, 0, PANEL_W, GetScreenHeight(), ColorAlpha(config.background, 0.85));
+    DrawLine(x, 0, x, GetScreenHeight(), config.border_color);
+    
+    if(catalog->count == 0)
+    {
+        DrawText("no patterns in " PATTERN_DIR, x + 8, 8, 10, config.hover_color);
+        return;
+    }
+    
+    for(int i = scroll ; i < catalog->count ; i++)
+    {
+        int y = (i - scroll) * entry_h;
+        if(y > GetScreenHeight())
+            break;
+        
+        CatalogEntry *entry = &catalog->entries[i];
+        if(i == selected)
+            DrawRectangle(x + 1, y, PANEL_W - 1, entry_h, ColorAlpha(config.hover_color, 0.3));
+        
+        DrawTexture(catalog_thumbnail(entry), x + 4, y + 4, WHITE);
+        DrawText(GetFileNameWithoutExt(entry->path), x + THUMB_SIZE + 12, y + 8, 10, config.hover_color);
+        DrawText(TextFormat("%d x %d", entry->pattern.w, entry->pattern.h), x + THUMB_SIZE + 12, y + 24, 10, GRAY);
+    }
+}
+
+void scheduler_reset(Scheduler *scheduler, double now)
+{
+    scheduler->accumulator = 1;
+    scheduler->prev_time = now;
+}
+
+// number of generations owed since the last call, at least one on the first frame after
+// a reset so starting feels immediate. unlimited mode asks for as many as the budget allows.
+long scheduler_due(Scheduler *scheduler, double now)
+{
+    scheduler->accumulator += (now - scheduler->prev_time) * scheduler->gens_per_sec;
+    scheduler->prev_time = now;
+    
+    if(scheduler->unlimited)
+        return 1L << 40;
+    
+    return scheduler->accumulator > 1e12 ? (long)1e12 : (long)scheduler->accumulator;
+}
+
+// when the budget ran out before catching up the backlog is dropped,
+// otherwise a slow frame would make every following frame slower too
+void scheduler_consume(Scheduler *scheduler, long steps, bool caught_up)
+{
+    if(scheduler->unlimited || !caught_up)
+        scheduler->accumulator -= (long)scheduler->accumulator;
+    else
+        scheduler->accumulator -= steps;
+}
+
+// true when the level changed and the board has to be drawn again. the frame budget is what
+// stepping leaves of 1 / config.fps, but never less than a quarter of it. without a target
+// frame rate there's no budget to keep.
+bool quality_update(Quality *quality, double step_ms, double draw_ms)
+{
+    static const char *names[] = { "full", "no grid lines", "square cells", "half rate" };
+    if(!config.adaptive || config.fps == 0)
+        return false;
+    
+    quality->step_ms += (step_ms - quality->step_ms) * 0.1;
+    quality->draw_ms += (draw_ms - quality->draw_ms) * 0.1;
+    double frame_ms = 1000.0 / config.fps;
+    double budget = frame_ms - quality->step_ms;
+    if(budget < frame_ms / 4)
+        budget = frame_ms / 4;
+    
+    quality->slow_frames = quality->draw_ms > budget ? quality->slow_frames + 1 : 0;
+    quality->fast_frames = quality->draw_ms < budget / 2 ? quality->fast_frames + 1 : 0;
+    
+    int level = quality->level;
+    quality->level_frames++;
+    if(quality->slow_frames >= QUALITY_DEGRADE_FRAMES && level < QUALITY_HALF_RATE)
+    {
+        bool failed_restore = quality->restored && quality->level_frames < quality->restore_wait;
+        if(failed_restore && quality->restore_wait < QUALITY_RESTORE_FRAMES * 16)
+            quality->restore_wait *= 2;
+        else if(!failed_restore)
+            quality->restore_wait = QUALITY_RESTORE_FRAMES;
+        quality->level++;
+        quality->restored = false;
+    }
+    else if(quality->fast_frames >= quality->restore_wait && level > QUALITY_FULL)
+    {
+        quality->level--;
+        quality->restored = true;
+    }
+    
+    if(quality->level == level)
+        return false;
+    quality->slow_frames = 0;
+    quality->fast_frames = 0;
+    quality->level_frames = 0;
+    TraceLog(LOG_INFO, "RENDER: quality %s, drawing took %.1f of %.1f ms", names[quality->level], quality->draw_ms, budget);
+    return true;
+}
+
+void iclamp(int *num, int min, int max)
+{
+    if(*num > max)
+        *num = max;
+    else if(*num < min)
+        *num = min;
+}
+
+// libgol's messages end up in raylib's log with everything else
+void log_forward(int level, const char *text)
+{
+    static const int levels[] = { LOG_INFO, LOG_WARNING, LOG_ERROR };
+    TraceLog(levels[level], "%s", text);
+}
+
+void log_stderr(int level, const char *text, va_list args)
+{
+    (void)level;
+    vfprintf(stderr, text, args);
+    fputc('\n', stderr);
+}
+
+// every cell alive or dead at random, for the runs without a window
+void randomize(GolBoard *board)
+{
+    bool *cells = gol_cells(board);
+    for(int i = 0 ; i < gol_width(board) * gol_height(board) ; i++)
+        cells[i] = rand() % 2;
+    gol_cells_changed(board, 0, 0, gol_width(board) - 1, gol_height(board) - 1);
 }
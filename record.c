@@ -0,0 +1,395 @@
+// recordings of a run without a window. the board is stepped on the calling thread, which
+// hands a copy of the cells to an encoder thread through a small queue, and only waits when
+// the encoder falls a whole queue behind. frames are drawn straight from the cells, one
+// palette index per pixel, and either LZW compressed into a GIF or written as raw RGB.
+#define RECORD_QUEUE 4
+#define RECORD_GIF_DELAY 4
+#define MAX_GIF_SIDE 65535
+#define LZW_MIN_CODE_SIZE 2
+#define LZW_MAX_CODES 4096
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "gol.h"
+#include "record.h"
+
+// the LZW compressor of one GIF frame. with 2 bit pixels every code has 4 children, so the
+// string table is a trie indexed by code and pixel, 0 meaning not there yet.
+typedef struct {
+    FILE *file;
+    unsigned char block[256];
+    int block_size;
+    uint32_t bits;
+    int bit_count;
+    int code_size;
+    int next_code;
+    int prefix;
+    uint16_t trie[LZW_MAX_CODES][4];
+} Lzw;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool *slots[RECORD_QUEUE];
+    int head;
+    int count;
+    bool finished;
+    bool failed;
+    int w;
+    int h;
+    int scale;
+    bool gif;
+    FILE *file;
+    unsigned char colors[2][3];
+    Lzw *lzw;
+} Recorder;
+
+static void *record_thread(void *arg);
+static bool frame_gif(Recorder *recorder, const bool *cells);
+static bool frame_raw(Recorder *recorder, const bool *cells);
+static void gif_begin(Recorder *recorder);
+static void lzw_begin(Lzw *lzw);
+static void lzw_put(Lzw *lzw, int pixel);
+static void lzw_end(Lzw *lzw);
+static void lzw_code(Lzw *lzw, int code);
+static void lzw_reset(Lzw *lzw);
+static void put_u16(FILE *file, int value);
+static bool ends_with(const char *text, const char *suffix);
+static double record_now(void);
+
+int record_run(GolBoard *board, const char *path, long frames, long generations, int scale,
+    const unsigned char colors[2][3])
+{
+    int w = gol_width(board);
+    int h = gol_height(board);
+    if(scale < 1)
+        scale = 1;
+    
+    Recorder recorder = { 0 };
+    recorder.w = w;
+    recorder.h = h;
+    recorder.scale = scale;
+    recorder.gif = ends_with(path, ".gif");
+    memcpy(recorder.colors, colors, sizeof(recorder.colors));
+    if(recorder.gif && ((long)w * scale > MAX_GIF_SIDE || (long)h * scale > MAX_GIF_SIDE))
+    {
+        fprintf(stderr, "RECORD: a GIF can't be larger than %d pixels a side\n", MAX_GIF_SIDE);
+        return 1;
+    }
+    
+    if(strcmp(path, "-") == 0)
+    {
+        #if defined(_WIN32)
+        _setmode(_fileno(stdout), _O_BINARY);
+        #endif
+        recorder.file = stdout;
+    }
+    else
+        recorder.file = fopen(path, "wb");
+    if(recorder.file == NULL)
+    {
+        fprintf(stderr, "RECORD: can't write %s\n", path);
+        return 1;
+    }
+    
+    for(int i = 0 ; i < RECORD_QUEUE ; i++)
+        recorder.slots[i] = malloc((size_t)w * h * sizeof(bool));
+    if(recorder.gif)
+    {
+        recorder.lzw = malloc(sizeof(Lzw));
+        recorder.lzw->file = recorder.file;
+        gif_begin(&recorder);
+    }
+    pthread_mutex_init(&recorder.lock, NULL);
+    pthread_cond_init(&recorder.changed, NULL);
+    
+    pthread_t thread;
+    pthread_create(&thread, NULL, record_thread, &recorder);
+    
+    double start = record_now();
+    double waited = 0;
+    long done = 0;
+    for( ; done < frames ; done++)
+    {
+        if(done > 0)
+            gol_step(board, generations);
+        
+        double wait_start = record_now();
+        pthread_mutex_lock(&recorder.lock);
+        while(recorder.count == RECORD_QUEUE && !recorder.failed)
+            pthread_cond_wait(&recorder.changed, &recorder.lock);
+        bool *slot = recorder.slots[(recorder.head + recorder.count) % RECORD_QUEUE];
+        bool failed = recorder.failed;
+        pthread_mutex_unlock(&recorder.lock);
+        waited += record_now() - wait_start;
+        if(failed)
+            break;
+        
+        // the encoder never reads past the queued slots, so this one can be filled unlocked
+        memcpy(slot, gol_cells(board), (size_t)w * h * sizeof(bool));
+        pthread_mutex_lock(&recorder.lock);
+        recorder.count++;
+        pthread_cond_signal(&recorder.changed);
+        pthread_mutex_unlock(&recorder.lock);
+    }
+    
+    pthread_mutex_lock(&recorder.lock);
+    recorder.finished = true;
+    pthread_cond_signal(&recorder.changed);
+    pthread_mutex_unlock(&recorder.lock);
+    pthread_join(thread, NULL);
+    
+    if(recorder.gif)
+        fputc(0x3b, recorder.file);
+    bool failed = recorder.failed || ferror(recorder.file);
+    if(recorder.file != stdout)
+        failed |= fclose(recorder.file) != 0;
+    else
+        fflush(stdout);
+    
+    if(failed)
+        fprintf(stderr, "RECORD: writing %s failed\n", path);
+    else
+        fprintf(
+            stderr, "RECORD: %ld frames of %dx%d in %.2f s, stepping waited %.2f s on the encoder\n",
+            done, w * scale, h * scale, record_now() - start, waited
+        );
+    
+    pthread_cond_destroy(&recorder.changed);
+    pthread_mutex_destroy(&recorder.lock);
+    for(int i = 0 ; i < RECORD_QUEUE ; i++)
+        free(recorder.slots[i]);
+    free(recorder.lzw);
+    return failed ? 1 : 0;
+}
+
+// encodes queued frames in order until the queue is empty and no more are coming
+static void *record_thread(void *arg)
+{
+    Recorder *recorder = arg;
+    while(true)
+    {
+        pthread_mutex_lock(&recorder->lock);
+        while(recorder->count == 0 && !recorder->finished)
+            pthread_cond_wait(&recorder->changed, &recorder->lock);
+        if(recorder->count == 0)
+        {
+            pthread_mutex_unlock(&recorder->lock);
+            return NULL;
+        }
+        const bool *cells = recorder->slots[recorder->head];
+        pthread_mutex_unlock(&recorder->lock);
+        
+        bool written = recorder->gif ? frame_gif(recorder, cells) : frame_raw(recorder, cells);
+        
+        pthread_mutex_lock(&recorder->lock);
+        recorder->head = (recorder->head + 1) % RECORD_QUEUE;
+        recorder->count--;
+        recorder->failed |= !written;
+        pthread_cond_signal(&recorder->changed);
+        pthread_mutex_unlock(&recorder->lock);
+        if(!written)
+            return NULL;
+    }
+}
+
+// one image of the animation: a graphic control extension for the delay, the image
+// descriptor and the compressed pixels, each cell `scale` x `scale` pixels
+static bool frame_gif(Recorder *recorder, const bool *cells)
+{
+    FILE *file = recorder->file;
+    int scale = recorder->scale;
+    fwrite("\x21\xf9\x04\x00", 1, 4, file);
+    put_u16(file, RECORD_GIF_DELAY);
+    fwrite("\x00\x00", 1, 2, file);
+    
+    fputc(0x2c, file);
+    put_u16(file, 0);
+    put_u16(file, 0);
+    put_u16(file, recorder->w * scale);
+    put_u16(file, recorder->h * scale);
+    fputc(0, file);
+    
+    Lzw *lzw = recorder->lzw;
+    lzw_begin(lzw);
+    for(int y = 0 ; y < recorder->h * scale ; y++)
+    {
+        const bool *row = cells + (size_t)(y / scale) * recorder->w;
+        for(int x = 0 ; x < recorder->w ; x++)
+            for(int i = 0 ; i < scale ; i++)
+                lzw_put(lzw, row[x]);
+    }
+    lzw_end(lzw);
+    return !ferror(file);
+}
+
+// rows of 24 bit RGB pixels, as ffmpeg's rawvideo rgb24 expects them
+static bool frame_raw(Recorder *recorder, const bool *cells)
+{
+    int scale = recorder->scale;
+    size_t row_size = (size_t)recorder->w * scale * 3;
+    unsigned char *pixels = malloc(row_size);
+    bool written = true;
+    for(int y = 0 ; y < recorder->h && written ; y++)
+    {
+        const bool *row = cells + (size_t)y * recorder->w;
+        unsigned char *out = pixels;
+        for(int x = 0 ; x < recorder->w ; x++)
+        {
+            for(int i = 0 ; i < scale ; i++)
+            {
+                memcpy(out, recorder->colors[row[x]], 3);
+                out += 3;
+            }
+        }
+        for(int i = 0 ; i < scale && written ; i++)
+            written = fwrite(pixels, 1, row_size, recorder->file) == row_size;
+    }
+    free(pixels);
+    return written;
+}
+
+// the header, a 4 color palette (the background, the cells and two unused entries,
+// the smallest table LZW allows) and the extension that makes the animation loop
+static void gif_begin(Recorder *recorder)
+{
+    FILE *file = recorder->file;
+    fwrite("GIF89a", 1, 6, file);
+    put_u16(file, recorder->w * recorder->scale);
+    put_u16(file, recorder->h * recorder->scale);
+    fputc(0x80 | (LZW_MIN_CODE_SIZE - 1), file);
+    fputc(0, file);
+    fputc(0, file);
+    
+    fwrite(recorder->colors[0], 1, 3, file);
+    fwrite(recorder->colors[1], 1, 3, file);
+    fwrite(recorder->colors[0], 1, 3, file);
+    fwrite(recorder->colors[0], 1, 3, file);
+    
+    fwrite("\x21\xff\x0bNETSCAPE2.0\x03\x01", 1, 16, file);
+    put_u16(file, 0);
+    fputc(0, file);
+}
+
+static void lzw_begin(Lzw *lzw)
+{
+    fputc(LZW_MIN_CODE_SIZE, lzw->file);
+    lzw->block_size = 0;
+    lzw->bits = 0;
+    lzw->bit_count = 0;
+    lzw->prefix = -1;
+    lzw_reset(lzw);
+    lzw_code(lzw, 1 << LZW_MIN_CODE_SIZE);
+}
+
+// extends the current string by `pixel`, sending its code once the table doesn't know the
+// longer string. the code size grows as the table does, and a full table is cleared, at the
+// same codes the decoder's table (always one entry behind) does.
+static void lzw_put(Lzw *lzw, int pixel)
+{
+    if(lzw->prefix < 0)
+    {
+        lzw->prefix = pixel;
+        return;
+    }
+    int code = lzw->trie[lzw->prefix][pixel];
+    if(code != 0)
+    {
+        lzw->prefix = code;
+        return;
+    }
+    
+    lzw_code(lzw, lzw->prefix);
+    if(lzw->next_code >= 1 << lzw->code_size)
+        lzw->code_size++;
+    if(lzw->next_code >= LZW_MAX_CODES - 1)
+    {
+        lzw_code(lzw, 1 << LZW_MIN_CODE_SIZE);
+        lzw_reset(lzw);
+    }
+    else
+        lzw->trie[lzw->prefix][pixel] = lzw->next_code++;
+    lzw->prefix = pixel;
+}
+
+// the last string, the end of information code and the remaining bits
+static void lzw_end(Lzw *lzw)
+{
+    lzw_code(lzw, lzw->prefix);
+    if(lzw->next_code >= 1 << lzw->code_size)
+        lzw->code_size++;
+    lzw_code(lzw, (1 << LZW_MIN_CODE_SIZE) + 1);
+    if(lzw->bit_count > 0)
+        lzw_code(lzw, -1);
+    if(lzw->block_size > 0)
+    {
+        fputc(lzw->block_size, lzw->file);
+        fwrite(lzw->block, 1, lzw->block_size, lzw->file);
+    }
+    fputc(0, lzw->file);
+}
+
+// packs codes least significant bit first into sub-blocks of up to 255 bytes.
+// -1 pads the last partial byte out.
+static void lzw_code(Lzw *lzw, int code)
+{
+    if(code >= 0)
+    {
+        lzw->bits |= (uint32_t)code << lzw->bit_count;
+        lzw->bit_count += lzw->code_size;
+    }
+    else
+        lzw->bit_count = (lzw->bit_count + 7) / 8 * 8;
+    
+    while(lzw->bit_count >= 8)
+    {
+        lzw->block[lzw->block_size++] = lzw->bits & 0xff;
+        lzw->bits >>= 8;
+        lzw->bit_count -= 8;
+        if(lzw->block_size == 255)
+        {
+            fputc(255, lzw->file);
+            fwrite(lzw->block, 1, 255, lzw->file);
+            lzw->block_size = 0;
+        }
+    }
+}
+
+// back to the single pixel strings, after the clear and end of information codes
+static void lzw_reset(Lzw *lzw)
+{
+    memset(lzw->trie, 0, sizeof(lzw->trie));
+    lzw->code_size = LZW_MIN_CODE_SIZE + 1;
+    lzw->next_code = (1 << LZW_MIN_CODE_SIZE) + 2;
+}
+
+static void put_u16(FILE *file, int value)
+{
+    fputc(value & 0xff, file);
+    fputc(value >> 8 & 0xff, file);
+}
+
+static bool ends_with(const char *text, const char *suffix)
+{
+    size_t n = strlen(text);
+    size_t m = strlen(suffix);
+    return n >= m && strcmp(text + n - m, suffix) == 0;
+}
+
+static double record_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
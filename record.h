@@ -0,0 +1,14 @@
+// recordings of a run without a window, see record.c
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "gol.h"
+
+// steps `board` `frames` times by `generations` generations, writing every frame to `path`
+// at `scale` pixels per cell: a looping GIF when the name ends in .gif, otherwise raw
+// 24 bit RGB frames ("-" for stdout). colors are the background and the live cells.
+// returns 1 if the output can't be written.
+int record_run(GolBoard *board, const char *path, long frames, long generations, int scale,
+    const unsigned char colors[2][3]);
+
+#endif
@@ -0,0 +1,808 @@
+// a headless run watched from a browser. the board is stepped on the calling thread,
+// a server thread speaks just enough HTTP and WebSocket (RFC 6455) to hand out the
+// viewer page and stream every client the part of the board it's looking at.
+// only 127.0.0.1 is listened on, and requests naming another host or coming from
+// another site's page are refused. SIGINT or SIGTERM stops the run.
+#define SERVER_FPS 30
+#define MAX_CLIENTS 16
+#define MAX_SCALE 256
+#define MAX_VIEW_SAMPLES (2048 * 2048)
+#define MAX_MESSAGE 4096
+#define FRAME_HEADER 48
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include "gol.h"
+#include "server.h"
+
+#if defined(__linux__)
+
+// a connection, reading an HTTP request until it's upgraded to a WebSocket.
+// the view is the rectangle of cells the client shows, every `scale` x `scale`
+// block of cells sent as one sample.
+typedef struct {
+    int fd;
+    bool upgraded;
+    unsigned char in[MAX_MESSAGE + 16];
+    size_t in_size;
+    bool has_view;
+    int view_x;
+    int view_y;
+    int view_w;
+    int view_h;
+    int scale;
+    long sent_serial;
+} Client;
+
+// the board as the simulation last handed it over. the simulation only ever
+// trylocks, and the server thread only holds the lock to swap the cells out,
+// so neither encoding nor a slow client ever holds up a step.
+typedef struct {
+    pthread_mutex_t lock;
+    atomic_bool wanted;
+    bool *cells;
+    int w;
+    int h;
+    long generation;
+    long population;
+    long serial;
+} Snapshot;
+
+typedef struct {
+    int listen_fd;
+    Client clients[MAX_CLIENTS];
+    int client_count;
+    Snapshot *snapshot;
+    // the snapshot frames are encoded from, its cells swapped with the simulation's
+    Snapshot shown;
+    unsigned char *frame;
+    int port;
+    atomic_bool stop;
+} Server;
+
+static volatile sig_atomic_t server_stopping = 0;
+
+static void *server_thread(void *arg);
+static void server_accept(Server *server);
+static bool client_read(Client *client);
+static bool client_http(Client *client, int port);
+static bool client_messages(Client *client, int board_w, int board_h);
+static void client_view(Client *client, const char *text, int board_w, int board_h);
+static const char *header_value(const char *request, const char *name);
+static bool host_local(const char *host);
+static bool origin_local(const char *origin, int port);
+static void server_signal(int sig);
+static size_t frame_encode(const Snapshot *snapshot, const Client *client, unsigned char *out);
+static bool ws_send(int fd, int opcode, const void *data, size_t size);
+static bool send_all(int fd, const void *data, size_t size);
+static void sha1(const unsigned char *data, size_t size, unsigned char digest[20]);
+static void base64(const unsigned char *data, size_t size, char *out);
+static double server_now(void);
+
+static const char viewer_html[] =
+    "<!doctype html>\n"
+    "<html><head><meta charset=\"utf-8\"><title>Game Of Life</title><style>\n"
+    "body { margin: 0; background: #000; overflow: hidden; }\n"
+    "canvas { display: block; }\n"
+    "#hud { position: fixed; left: 8px; top: 8px; color: #87ceeb; font: 14px monospace; }\n"
+    "</style></head><body><canvas id=\"screen\"></canvas><div id=\"hud\">connecting</div><script>\n"
+    "const screen = document.getElementById('screen'), ctx = screen.getContext('2d');\n"
+    "const hud = document.getElementById('hud');\n"
+    "const frame = document.createElement('canvas'), frameCtx = frame.getContext('2d');\n"
+    "// zoom is screen pixels per cell, below 1 the server sends blocks of cells\n"
+    "let view = { x: 0, y: 0, zoom: 4 }, board = { w: 0, h: 0 }, socket = null, last = null;\n"
+    "function sendView() {\n"
+    "    if(!socket || socket.readyState !== 1) return;\n"
+    "    const w = Math.ceil(screen.width / view.zoom) + 1, h = Math.ceil(screen.height / view.zoom) + 1;\n"
+    "    const scale = Math.max(1, Math.floor(1 / view.zoom));\n"
+    "    socket.send(`view ${Math.floor(view.x)} ${Math.floor(view.y)} ${w} ${h} ${scale}`);\n"
+    "}\n"
+    "function connect() {\n"
+    "    socket = new WebSocket(`ws://${location.host}/ws`);\n"
+    "    socket.binaryType = 'arraybuffer';\n"
+    "    socket.onopen = sendView;\n"
+    "    socket.onclose = () => { hud.textContent = 'disconnected'; setTimeout(connect, 1000); };\n"
+    "    socket.onmessage = event => { last = event.data; draw(); };\n"
+    "}\n"
+    "function draw() {\n"
+    "    if(!last) return;\n"
+    "    const d = new DataView(last), u = i => d.getUint32(4 * i, true);\n"
+    "    const x = u(0), y = u(1), scale = u(4), outW = u(5), outH = u(6);\n"
+    "    board = { w: u(7), h: u(8) };\n"
+    "    const image = frameCtx.createImageData(Math.max(outW, 1), Math.max(outH, 1));\n"
+    "    const pixels = new Uint32Array(image.data.buffer), bytes = new Uint8Array(last, 48);\n"
+    "    let p = 0, i = 0, alive = false;\n"
+    "    while(i < outW * outH && p < bytes.length) {\n"
+    "        let run = 0, shift = 0, b;\n"
+    "        do { b = bytes[p++]; run += (b & 127) * 2 ** shift; shift += 7; } while(b & 128);\n"
+    "        if(alive) pixels.fill(0xff00a1ff, i, Math.min(i + run, outW * outH));\n"
+    "        i += run;\n"
+    "        alive = !alive;\n"
+    "    }\n"
+    "    frame.width = image.width; frame.height = image.height;\n"
+    "    frameCtx.putImageData(image, 0, 0);\n"
+    "    ctx.imageSmoothingEnabled = false;\n"
+    "    ctx.fillStyle = '#000'; ctx.fillRect(0, 0, screen.width, screen.height);\n"
+    "    ctx.strokeStyle = '#fdf900';\n"
+    "    ctx.strokeRect(-view.x * view.zoom, -view.y * view.zoom, board.w * view.zoom, board.h * view.zoom);\n"
+    "    ctx.drawImage(frame, 0, 0, outW, outH, (x - view.x) * view.zoom, (y - view.y) * view.zoom,\n"
+    "        outW * scale * view.zoom, outH * scale * view.zoom);\n"
+    "    hud.textContent = `generation ${d.getFloat64(36, true)}  population ${u(11)}  ${board.w}x${board.h}`;\n"
+    "}\n"
+    "function resize() { screen.width = innerWidth; screen.height = innerHeight; sendView(); draw(); }\n"
+    "let drag = null;\n"
+    "screen.onmousedown = e => { drag = { x: e.clientX, y: e.clientY }; };\n"
+    "onmouseup = () => { drag = null; };\n"
+    "onmousemove = e => {\n"
+    "    if(!drag) return;\n"
+    "    view.x -= (e.clientX - drag.x) / view.zoom; view.y -= (e.clientY - drag.y) / view.zoom;\n"
+    "    drag = { x: e.clientX, y: e.clientY };\n"
+    "    sendView(); draw();\n"
+    "};\n"
+    "screen.onwheel = e => {\n"
+    "    e.preventDefault();\n"
+    "    const zoom = Math.min(64, Math.max(1 / 256, view.zoom * (e.deltaY < 0 ? 1.25 : 0.8)));\n"
+    "    view.x += e.clientX / view.zoom - e.clientX / zoom; view.y += e.clientY / view.zoom - e.clientY / zoom;\n"
+    "    view.zoom = zoom;\n"
+    "    sendView(); draw();\n"
+    "};\n"
+    "onresize = resize;\n"
+    "resize();\n"
+    "connect();\n"
+    "</script></body></html>\n";
+
+int server_run(GolBoard *board, int port, double gens_per_sec)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    
+    struct sockaddr_in address = { 0 };
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0)
+    {
+        fprintf(stderr, "SERVER: can't listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        if(fd >= 0)
+            close(fd);
+        return 1;
+    }
+    
+    int w = gol_width(board);
+    int h = gol_height(board);
+    Snapshot snapshot = { 0 };
+    pthread_mutex_init(&snapshot.lock, NULL);
+    atomic_init(&snapshot.wanted, true);
+    snapshot.cells = calloc((size_t)w * h, sizeof(bool));
+    snapshot.w = w;
+    snapshot.h = h;
+    
+    Server *server = calloc(1, sizeof(Server));
+    server->listen_fd = fd;
+    server->snapshot = &snapshot;
+    server->shown = (Snapshot){ .cells = calloc((size_t)w * h, sizeof(bool)), .w = w, .h = h };
+    server->frame = malloc(FRAME_HEADER + MAX_VIEW_SAMPLES + 16);
+    server->port = port;
+    atomic_init(&server->stop, false);
+    
+    server_stopping = 0;
+    signal(SIGINT, server_signal);
+    signal(SIGTERM, server_signal);
+    
+    pthread_t thread;
+    pthread_create(&thread, NULL, server_thread, server);
+    printf("SERVER: watch the board on http://127.0.0.1:%d\n", port);
+    fflush(stdout);
+    
+    double start = server_now();
+    long first = gol_stats(board).generation;
+    long done = 0;
+    while(!server_stopping)
+    {
+        // as fast as it goes a few generations at a time, so frames keep coming
+        long due = gens_per_sec > 0 ? (long)((server_now() - start) * gens_per_sec) - done : 4;
+        if(due <= 0)
+        {
+            nanosleep(&(struct timespec){ 0, 1000000 }, NULL);
+            continue;
+        }
+        if(due > 1000)
+            due = 1000;
+        done += gol_step(board, due);
+        
+        if(atomic_load(&snapshot.wanted) && pthread_mutex_trylock(&snapshot.lock) == 0)
+        {
+            // the population is counted by the server thread, off the stepping one
+            memcpy(snapshot.cells, gol_cells(board), (size_t)w * h);
+            snapshot.generation = first + done;
+            snapshot.serial++;
+            atomic_store(&snapshot.wanted, false);
+            pthread_mutex_unlock(&snapshot.lock);
+        }
+    }
+    
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    atomic_store(&server->stop, true);
+    pthread_join(thread, NULL);
+    for(int i = 0 ; i < server->client_count ; i++)
+        close(server->clients[i].fd);
+    close(fd);
+    free(server->frame);
+    free(server->shown.cells);
+    free(server);
+    free(snapshot.cells);
+    pthread_mutex_destroy(&snapshot.lock);
+    printf("SERVER: stopped at generation %ld\n", gol_stats(board).generation);
+    return 0;
+}
+
+static void server_signal(int sig)
+{
+    (void)sig;
+    server_stopping = 1;
+}
+
+// polls the sockets, and every 1 / SERVER_FPS seconds asks for a snapshot
+// and sends each client with a view the new frame
+static void *server_thread(void *arg)
+{
+    Server *server = arg;
+    Snapshot *snapshot = server->snapshot;
+    double next_frame = server_now();
+    
+    while(!atomic_load(&server->stop))
+    {
+        struct pollfd fds[MAX_CLIENTS + 1];
+        fds[0] = (struct pollfd){ server->listen_fd, POLLIN, 0 };
+        for(int i = 0 ; i < server->client_count ; i++)
+            fds[i + 1] = (struct pollfd){ server->clients[i].fd, POLLIN, 0 };
+        
+        int polled = server->client_count;
+        int timeout = (next_frame - server_now()) * 1000;
+        poll(fds, polled + 1, timeout > 0 ? timeout : 0);
+        
+        for(int i = polled - 1 ; i >= 0 ; i--)
+        {
+            Client *client = &server->clients[i];
+            if(!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            
+            bool open = client_read(client);
+            if(open && !client->upgraded)
+                open = client_http(client, server->port);
+            if(open && client->upgraded)
+                open = client_messages(client, snapshot->w, snapshot->h);
+            
+            if(!open)
+            {
+                close(client->fd);
+                server->clients[i] = server->clients[--server->client_count];
+            }
+        }
+        
+        if(fds[0].revents & POLLIN)
+            server_accept(server);
+        
+        if(server_now() < next_frame)
+            continue;
+        next_frame += 1.0 / SERVER_FPS;
+        if(next_frame < server_now())
+            next_frame = server_now() + 1.0 / SERVER_FPS;
+        
+        // swap the newest cells out, then encode and send (up to a second
+        // per slow client) with the lock released
+        Snapshot *shown = &server->shown;
+        bool fresh = false;
+        pthread_mutex_lock(&snapshot->lock);
+        if(snapshot->serial != shown->serial)
+        {
+            bool *cells = shown->cells;
+            shown->cells = snapshot->cells;
+            snapshot->cells = cells;
+            shown->generation = snapshot->generation;
+            shown->serial = snapshot->serial;
+            fresh = true;
+        }
+        pthread_mutex_unlock(&snapshot->lock);
+        atomic_store(&snapshot->wanted, true);
+        
+        if(fresh)
+        {
+            shown->population = 0;
+            for(size_t i = 0 ; i < (size_t)shown->w * shown->h ; i++)
+                shown->population += shown->cells[i];
+        }
+        for(int i = server->client_count - 1 ; i >= 0 && shown->serial > 0 ; i--)
+        {
+            Client *client = &server->clients[i];
+            if(!client->upgraded || !client->has_view || client->sent_serial == shown->serial)
+                continue;
+            
+            size_t size = frame_encode(shown, client, server->frame);
+            client->sent_serial = shown->serial;
+            if(!ws_send(client->fd, 2, server->frame, size))
+            {
+                close(client->fd);
+                server->clients[i] = server->clients[--server->client_count];
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+static void server_accept(Server *server)
+{
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if(fd < 0)
+        return;
+    if(server->client_count == MAX_CLIENTS)
+    {
+        close(fd);
+        return;
+    }
+    
+    // a client that stops reading is dropped rather than blocking everyone else
+    struct timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    Client *client = &server->clients[server->client_count++];
+    memset(client, 0, sizeof(*client));
+    client->fd = fd;
+    client->sent_serial = -1;
+}
+
+static bool client_read(Client *client)
+{
+    if(client->in_size >= MAX_MESSAGE)
+        return false;
+    
+    ssize_t n = recv(client->fd, client->in + client->in_size, MAX_MESSAGE - client->in_size, 0);
+    if(n <= 0)
+        return false;
+    client->in_size += n;
+    return true;
+}
+
+// answers a complete request: the viewer page for /, the WebSocket handshake for /ws.
+// returns false once the connection should be closed.
+static bool client_http(Client *client, int port)
+{
+    client->in[client->in_size] = '\0';
+    char *request = (char*)client->in;
+    char *end = strstr(request, "\r\n\r\n");
+    if(end == NULL)
+        return true;
+    
+    char path[256] = "";
+    sscanf(request, "GET %255s", path);
+    
+    // browsers send the host they were pointed at, anything but a local name
+    // means some other site is trying to reach the server through the browser.
+    // a rebound name still says which page opened the socket in its Origin.
+    const char *host = header_value(request, "Host");
+    const char *origin = header_value(request, "Origin");
+    bool local = host != NULL && host_local(host);
+    if(strcmp(path, "/ws") == 0 && origin != NULL && !origin_local(origin, port))
+        local = false;
+    
+    const char *key = header_value(request, "Sec-WebSocket-Key");
+    char header[512];
+    if(!local)
+    {
+        snprintf(header, sizeof(header), "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        send_all(client->fd, header, strlen(header));
+        return false;
+    }
+    if(strcmp(path, "/") == 0)
+    {
+        snprintf(
+            header, sizeof(header),
+            "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+            sizeof(viewer_html) - 1
+        );
+        send_all(client->fd, header, strlen(header));
+        send_all(client->fd, viewer_html, sizeof(viewer_html) - 1);
+        return false;
+    }
+    if(strcmp(path, "/ws") != 0 || key == NULL)
+    {
+        snprintf(header, sizeof(header), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        send_all(client->fd, header, strlen(header));
+        return false;
+    }
+    
+    // the accept key is base64(sha1(key + the protocol's fixed GUID))
+    char joined[128];
+    int key_size = strcspn(key, "\r\n");
+    if(key_size > 64)
+        return false;
+    snprintf(joined, sizeof(joined), "%.*s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", key_size, key);
+    
+    unsigned char digest[20];
+    char accept[32];
+    sha1((const unsigned char*)joined, strlen(joined), digest);
+    base64(digest, sizeof(digest), accept);
+    
+    snprintf(
+        header, sizeof(header),
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n",
+        accept
+    );
+    if(!send_all(client->fd, header, strlen(header)))
+        return false;
+    
+    // anything after the request already belongs to the WebSocket
+    size_t used = end + 4 - request;
+    memmove(client->in, client->in + used, client->in_size - used);
+    client->in_size -= used;
+    client->upgraded = true;
+    return true;
+}
+
+// handles the complete frames received so far. clients only send text messages
+// "view x y w h scale", pings and closes.
+static bool client_messages(Client *client, int board_w, int board_h)
+{
+    while(client->in_size >= 2)
+    {
+        unsigned char *in = client->in;
+        int opcode = in[0] & 0x0f;
+        size_t size = in[1] & 0x7f;
+        size_t offset = 2;
+        if(!(in[1] & 0x80))
+            return false;
+        if(size == 126)
+        {
+            if(client->in_size < 4)
+                return true;
+            size = in[2] << 8 | in[3];
+            offset = 4;
+        }
+        else if(size == 127)
+        {
+            return false;
+        }
+        if(size > MAX_MESSAGE || client->in_size < offset + 4 + size)
+            return size <= MAX_MESSAGE;
+        
+        unsigned char *mask = in + offset;
+        unsigned char *payload = in + offset + 4;
+        for(size_t i = 0 ; i < size ; i++)
+            payload[i] ^= mask[i % 4];
+        
+        if(opcode == 8)
+            return false;
+        if(opcode == 9 && !ws_send(client->fd, 10, payload, size))
+            return false;
+        if(opcode == 1)
+        {
+            char text[64];
+            snprintf(text, sizeof(text), "%.*s", (int)size, (const char*)payload);
+            client_view(client, text, board_w, board_h);
+        }
+        
+        size_t used = offset + 4 + size;
+        memmove(client->in, client->in + used, client->in_size - used);
+        client->in_size -= used;
+    }
+    return true;
+}
+
+// the view is clamped to the board here, in long long so no client's numbers can overflow
+static void client_view(Client *client, const char *text, int board_w, int board_h)
+{
+    int x, y, w, h, scale;
+    if(sscanf(text, "view %d %d %d %d %d", &x, &y, &w, &h, &scale) != 5)
+        return;
+    
+    long long x0 = x < 0 ? 0 : x > board_w ? board_w : x;
+    long long y0 = y < 0 ? 0 : y > board_h ? board_h : y;
+    long long x1 = (long long)x + (w > 0 ? w : 0);
+    long long y1 = (long long)y + (h > 0 ? h : 0);
+    x1 = x1 < x0 ? x0 : x1 > board_w ? board_w : x1;
+    y1 = y1 < y0 ? y0 : y1 > board_h ? board_h : y1;
+    client->view_x = x0;
+    client->view_y = y0;
+    client->view_w = x1 - x0;
+    client->view_h = y1 - y0;
+    client->scale = scale < 1 ? 1 : scale > MAX_SCALE ? MAX_SCALE : scale;
+    client->has_view = true;
+    client->sent_serial = -1;
+}
+
+// the value of header `name` in a request, NULL if it has none
+static const char *header_value(const char *request, const char *name)
+{
+    size_t n = strlen(name);
+    for(const char *line = strstr(request, "\r\n") ; line != NULL ; line = strstr(line + 2, "\r\n"))
+    {
+        if(strncasecmp(line + 2, name, n) == 0 && line[2 + n] == ':')
+        {
+            const char *value = line + 3 + n;
+            while(*value == ' ')
+                value++;
+            return value;
+        }
+    }
+    return NULL;
+}
+
+// whether a Host value is exactly 127.0.0.1, localhost or [::1], with or without a port
+static bool host_local(const char *host)
+{
+    static const char *names[] = { "127.0.0.1", "localhost", "[::1]" };
+    for(int i = 0 ; i < 3 ; i++)
+    {
+        size_t n = strlen(names[i]);
+        if(strncasecmp(host, names[i], n) != 0)
+            continue;
+        
+        const char *rest = host + n;
+        if(*rest == ':')
+        {
+            rest++;
+            if(*rest < '0' || *rest > '9')
+                return false;
+            while(*rest >= '0' && *rest <= '9')
+                rest++;
+        }
+        while(*rest == ' ' || *rest == '\t')
+            rest++;
+        return *rest == '\r' || *rest == '\n' || *rest == '\0';
+    }
+    return false;
+}
+
+// whether an Origin value is the viewer page this server handed out
+static bool origin_local(const char *origin, int port)
+{
+    size_t n = strcspn(origin, "\r\n");
+    while(n > 0 && (origin[n - 1] == ' ' || origin[n - 1] == '\t'))
+        n--;
+    
+    char expected[2][64];
+    snprintf(expected[0], sizeof(expected[0]), "http://127.0.0.1:%d", port);
+    snprintf(expected[1], sizeof(expected[1]), "http://localhost:%d", port);
+    for(int i = 0 ; i < 2 ; i++)
+        if(strlen(expected[i]) == n && strncasecmp(origin, expected[i], n) == 0)
+            return true;
+    return false;
+}
+
+static void put_u32(unsigned char *out, uint32_t v)
+{
+    for(int i = 0 ; i < 4 ; i++)
+        out[i] = v >> (8 * i);
+}
+
+static void put_f64(unsigned char *out, double v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    for(int i = 0 ; i < 8 ; i++)
+        out[i] = bits >> (8 * i);
+}
+
+// a frame is a little-endian header (view x, y, w, h, scale, samples across, samples down,
+// board w, h, population, generation as a double) followed by the samples row by row as
+// alternating runs of dead and live samples, each a LEB128 varint, starting with dead.
+// a sample is alive when any cell of its scale x scale block is.
+static size_t frame_encode(const Snapshot *snapshot, const Client *client, unsigned char *out)
+{
+    // client_view() already clamped the view to the board
+    int scale = client->scale;
+    int x0 = client->view_x;
+    int y0 = client->view_y;
+    int w = client->view_w;
+    int h = client->view_h;
+    
+    // views too big to send at their scale are sampled coarser
+    while((long)((w + scale - 1) / scale) * ((h + scale - 1) / scale) > MAX_VIEW_SAMPLES)
+        scale *= 2;
+    int out_w = (w + scale - 1) / scale;
+    int out_h = (h + scale - 1) / scale;
+    
+    uint32_t header[] = { x0, y0, w, h, scale, out_w, out_h, snapshot->w, snapshot->h };
+    for(int i = 0 ; i < 9 ; i++)
+        put_u32(out + 4 * i, header[i]);
+    put_f64(out + 36, snapshot->generation);
+    put_u32(out + 44, snapshot->population);
+    
+    size_t size = FRAME_HEADER;
+    bool alive = false;
+    uint32_t run = 0;
+    for(int i = 0 ; i < out_h ; i++)
+    {
+        int y_end = y0 + (i + 1) * scale < y0 + h ? y0 + (i + 1) * scale : y0 + h;
+        for(int j = 0 ; j < out_w ; j++)
+        {
+            int x = x0 + j * scale;
+            int x_end = x + scale < x0 + w ? x + scale : x0 + w;
+            bool sample = false;
+            for(int y = y0 + i * scale ; y < y_end && !sample ; y++)
+                sample = memchr(snapshot->cells + (size_t)y * snapshot->w + x, 1, x_end - x) != NULL;
+            
+            if(sample != alive)
+            {
+                for( ; run >= 0x80 ; run >>= 7)
+                    out[size++] = (run & 0x7f) | 0x80;
+                out[size++] = run;
+                run = 0;
+                alive = sample;
+            }
+            run++;
+        }
+    }
+    for( ; run >= 0x80 ; run >>= 7)
+        out[size++] = (run & 0x7f) | 0x80;
+    out[size++] = run;
+    
+    return size;
+}
+
+// one unmasked, unfragmented frame, as servers send them
+static bool ws_send(int fd, int opcode, const void *data, size_t size)
+{
+    unsigned char head[10];
+    size_t n = 0;
+    head[n++] = 0x80 | opcode;
+    if(size < 126)
+    {
+        head[n++] = size;
+    }
+    else if(size < 65536)
+    {
+        head[n++] = 126;
+        head[n++] = size >> 8;
+        head[n++] = size;
+    }
+    else
+    {
+        head[n++] = 127;
+        for(int i = 7 ; i >= 0 ; i--)
+            head[n++] = (uint64_t)size >> (8 * i);
+    }
+    return send_all(fd, head, n) && send_all(fd, data, size);
+}
+
+static bool send_all(int fd, const void *data, size_t size)
+{
+    const char *p = data;
+    while(size > 0)
+    {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if(n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+static uint32_t rotl(uint32_t v, int n)
+{
+    return v << n | v >> (32 - n);
+}
+
+// FIPS 180-1, only used for the WebSocket handshake
+static void sha1(const unsigned char *data, size_t size, unsigned char digest[20])
+{
+    uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+    
+    // the message, a 1 bit, zeros and the length in bits, in whole 64 byte blocks
+    size_t padded = (size + 8) / 64 * 64 + 64;
+    unsigned char *message = calloc(padded, 1);
+    memcpy(message, data, size);
+    message[size] = 0x80;
+    for(int i = 0 ; i < 8 ; i++)
+        message[padded - 1 - i] = (uint64_t)size * 8 >> (8 * i);
+    
+    for(size_t block = 0 ; block < padded ; block += 64)
+    {
+        uint32_t w[80];
+        for(int i = 0 ; i < 16 ; i++)
+        {
+            const unsigned char *p = message + block + 4 * i;
+            w[i] = (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+        }
+        for(int i = 16 ; i < 80 ; i++)
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for(int i = 0 ; i < 80 ; i++)
+        {
+            uint32_t f, k;
+            if(i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            }
+            else if(i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if(i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    free(message);
+    
+    for(int i = 0 ; i < 20 ; i++)
+        digest[i] = h[i / 4] >> (24 - 8 * (i % 4));
+}
+
+// standard alphabet with padding, `out` needs 4 * ((size + 2) / 3) + 1 bytes
+static void base64(const unsigned char *data, size_t size, char *out)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for(size_t i = 0 ; i < size ; i += 3)
+    {
+        uint32_t v = data[i] << 16 | (i + 1 < size ? data[i + 1] << 8 : 0) | (i + 2 < size ? data[i + 2] : 0);
+        *out++ = alphabet[v >> 18 & 63];
+        *out++ = alphabet[v >> 12 & 63];
+        *out++ = i + 1 < size ? alphabet[v >> 6 & 63] : '=';
+        *out++ = i + 2 < size ? alphabet[v & 63] : '=';
+    }
+    *out = '\0';
+}
+
+static double server_now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#else
+
+int server_run(GolBoard *board, int port, double gens_per_sec)
+{
+    (void)board;
+    (void)port;
+    (void)gens_per_sec;
+    fprintf(stderr, "SERVER: serving is only supported on Linux\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,12 @@
+// headless runs watched from a browser, see server.c
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "gol.h"
+
+// steps `board` until SIGINT or SIGTERM, `gens_per_sec` generations a second or as fast
+// as it goes when 0, while serving a viewer on http://127.0.0.1:port.
+// returns 1 if the server can't start, 0 once it has stopped.
+int server_run(GolBoard *board, int port, double gens_per_sec);
+
+#endif
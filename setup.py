@@ -0,0 +1,15 @@
+# builds the `gol` Python module over libgol: python3 setup.py build_ext --inplace
+from setuptools import setup, Extension
+
+setup(
+    name="gol",
+    version="1.0",
+    ext_modules=[
+        Extension(
+            "gol",
+            sources=["golmodule.c", "gol.c"],
+            extra_compile_args=["-O2", "-Wall", "-Wextra"],
+            libraries=["m", "pthread"],
+        )
+    ],
+)
@@ -0,0 +1,34 @@
+# checks of the gol module that need Python, run by `make test` after `make python`
+import gol
+
+
+def blinker_through_buffer(rule, engine):
+    board = gol.Board(16, 16, rule, engine)
+    cells = memoryview(board)
+    for x in range(6, 9):
+        cells[7, x] = 1
+    before = board.stats()["population"]
+    board.step()
+    after = [(x, y) for y in range(16) for x in range(16) if cells[y, x]]
+    cells.release()
+    return before, after
+
+
+# the planes are what these boards step, writes to the buffer have to reach them
+before, after = blinker_through_buffer("B3/S23", "packed")
+assert before == 3, before
+assert after == [(7, 6), (7, 7), (7, 8)], after
+
+# Brian's Brain: the three cells start dying, the cells beside the ends are born
+before, after = blinker_through_buffer("B2/S/C3", "auto")
+assert before == 3, before
+assert after == [(6, 6), (8, 6), (6, 8), (8, 8)], after
+
+board = gol.Board(16, 16, "B3/S23", "tiled")
+cells = memoryview(board)
+cells[7, 6] = cells[7, 7] = cells[7, 8] = 1
+board.step(2)
+assert board.stats()["population"] == 3
+cells.release()
+
+print("gol module ok")